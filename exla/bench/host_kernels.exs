@@ -0,0 +1,104 @@
+# Compares the native host kernels registered as custom calls
+# against their pure HLO lowering. Both sides are compiled to
+# executables up front and run on the same buffers, so only the
+# computations themselves are measured.
+#
+#     mix run bench/host_kernels.exs
+
+alias EXLA.{Buffer, Builder, Computation, Executable, Lib, Op, Shape}
+
+batch = 128
+n = 4096
+k = 16
+
+rand = for(_ <- 1..(batch * n), do: :rand.uniform())
+t = Nx.tensor(rand, type: {:f, 32}) |> Nx.reshape({batch, n})
+gamma = Nx.broadcast(Nx.tensor(1.0, type: {:f, 32}), {n})
+beta = Nx.broadcast(Nx.tensor(0.0, type: {:f, 32}), {n})
+
+defmodule HLO do
+  @type_ {:f, 32}
+
+  def softmax(builder, x) do
+    max = Op.reduce(x, Lib.min_value(builder, @type_), computation(builder, :max), {1})
+    exp = Op.exp(Op.subtract(x, max, {0}))
+    Op.divide(exp, sum(builder, exp), {0})
+  end
+
+  def layer_norm(builder, x, gamma, beta, n) do
+    size = Op.constant_r0(builder, n, @type_)
+    centered = Op.subtract(x, Op.divide(sum(builder, x), size), {0})
+    var = Op.divide(sum(builder, Op.multiply(centered, centered)), size)
+    inv_std = Op.rsqrt(Op.add(var, Op.constant_r0(builder, 1.0e-5, @type_)))
+
+    centered
+    |> Op.multiply(inv_std, {0})
+    |> Op.multiply(gamma, {1})
+    |> Op.add(beta, {1})
+  end
+
+  # Full descending sort, which is what top-k lowers to without a kernel
+  def top_k(builder, x, batch, k) do
+    x
+    |> Op.sort(computation(builder, :greater), 1)
+    |> Op.slice([0, 0], [batch, k], [1, 1])
+  end
+
+  defp sum(builder, op) do
+    Op.reduce(op, Op.constant_r0(builder, 0.0, @type_), Lib.add_computation(builder, @type_), {1})
+  end
+
+  defp computation(builder, fun) do
+    sub_builder = Builder.new(builder, "host_kernels-#{fun}")
+    lhs = Op.parameter(sub_builder, 0, Shape.make_shape(@type_, {}), "lhs")
+    rhs = Op.parameter(sub_builder, 1, Shape.make_shape(@type_, {}), "rhs")
+    Builder.build(apply(Op, fun, [lhs, rhs]))
+  end
+end
+
+defmodule Bench do
+  def compile(tensors, fun) do
+    client = EXLA.Client.fetch!(:default)
+    builder = Builder.new("host_kernels")
+
+    {params, shapes} =
+      tensors
+      |> Enum.with_index()
+      |> Enum.map(fn {t, i} ->
+        shape = Shape.make_shape(Nx.type(t), Nx.shape(t))
+        {Op.parameter(builder, i, shape, "p#{i}"), shape}
+      end)
+      |> Enum.unzip()
+
+    exec =
+      builder
+      |> Op.tuple([fun.(builder, params)])
+      |> Builder.build()
+      |> Computation.compile(client, shapes)
+
+    buffers =
+      tensors
+      |> Enum.zip(shapes)
+      |> Enum.map(fn {t, shape} -> %Buffer{data: Nx.to_binary(t), shape: shape} end)
+
+    fn -> Executable.run(exec, buffers) end
+  end
+end
+
+Benchee.run(
+  %{
+    "softmax hlo" => Bench.compile([t], fn b, [x] -> HLO.softmax(b, x) end),
+    "softmax kernel" => Bench.compile([t], fn b, [x] -> Lib.host_softmax(b, x) end),
+    "layer_norm hlo" =>
+      Bench.compile([t, gamma, beta], fn b, [x, g, bt] -> HLO.layer_norm(b, x, g, bt, n) end),
+    "layer_norm kernel" =>
+      Bench.compile([t, gamma, beta], fn b, [x, g, bt] -> Lib.host_layer_norm(b, x, g, bt) end),
+    "top_k hlo (sort)" => Bench.compile([t], fn b, [x] -> HLO.top_k(b, x, batch, k) end),
+    "top_k kernel" =>
+      Bench.compile([t], fn b, [x] ->
+        b |> Lib.host_top_k(x, k) |> Op.get_tuple_element(0)
+      end)
+  },
+  time: 10,
+  memory_time: 2
+)
@@ -1,9 +1,12 @@
+#include <cstring>
 #include <map>
 
 #include "tensorflow/compiler/xla/exla/exla_nif_util.h"
 #include "tensorflow/compiler/xla/exla/exla_client.h"
 #include "tensorflow/compiler/xla/exla/exla_log_sink.h"
 #include "tensorflow/compiler/xla/exla/exla_aot_compilation.h"
+#include "tensorflow/compiler/xla/exla/exla_custom_calls.h"
+#include "tensorflow/compiler/xla/exla/exla_hlo_passes.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
@@ -13,6 +16,7 @@
 #include "tensorflow/compiler/xla/client/lib/lu_decomposition.h"
 #include "tensorflow/compiler/xla/client/lib/qr.h"
 #include "tensorflow/compiler/xla/client/lib/self_adjoint_eig.h"
+#include "tensorflow/compiler/xla/client/lib/sorting.h"
 #include "tensorflow/compiler/xla/client/lib/svd.h"
 #include "tensorflow/compiler/xla/primitive_util.h"
 
@@ -85,6 +89,8 @@ static int open_resources(ErlNifEnv* env) {
 static int load(ErlNifEnv* env, void** priv, ERL_NIF_TERM load_info) {
   if (open_resources(env) == -1) return -1;
 
+  exla::RegisterCustomCallTargets();
+
   return 0;
 }
 
@@ -231,6 +237,78 @@ ERL_NIF_TERM read_device_mem(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]
   return exla::nif::ok(env, binary);
 }
 
+// Infeed/Outfeed transfers
+
+ERL_NIF_TERM transfer_to_infeed(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 4) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::ExlaClient** client;
+  int device_ordinal;
+  ErlNifBinary bin;
+  xla::Shape* shape;
+
+  if (!exla::nif::get<exla::ExlaClient*>(env, argv[0], client)) {
+    return exla::nif::error(env, "Unable to get client.");
+  }
+  if (!exla::nif::get(env, argv[1], &device_ordinal)) {
+    return exla::nif::error(env, "Unable to get device ordinal.");
+  }
+  if (!exla::nif::get_binary(env, argv[2], &bin)) {
+    return exla::nif::error(env, "Unable to get data.");
+  }
+  if (!exla::nif::get<xla::Shape>(env, argv[3], shape)) {
+    return exla::nif::error(env, "Unable to get shape.");
+  }
+
+  exla::int64 size = xla::ShapeUtil::ByteSizeOf(*shape);
+  if (size != bin.size) {
+    return exla::nif::error(env, "Binary size does not match the infeed shape.");
+  }
+
+  exla::ExlaDevice* device = (*client)->device(device_ordinal);
+  xla::BorrowingLiteral literal(reinterpret_cast<const char*>(bin.data), *shape);
+
+  xla::Status status = device->TransferToInfeed(literal);
+  if (!status.ok()) {
+    return exla::nif::error(env, status.error_message().c_str());
+  }
+
+  return exla::nif::ok(env);
+}
+
+ERL_NIF_TERM transfer_from_outfeed(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 3) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::ExlaClient** client;
+  int device_ordinal;
+  xla::Shape* shape;
+
+  if (!exla::nif::get<exla::ExlaClient*>(env, argv[0], client)) {
+    return exla::nif::error(env, "Unable to get client.");
+  }
+  if (!exla::nif::get(env, argv[1], &device_ordinal)) {
+    return exla::nif::error(env, "Unable to get device ordinal.");
+  }
+  if (!exla::nif::get<xla::Shape>(env, argv[2], shape)) {
+    return exla::nif::error(env, "Unable to get shape.");
+  }
+
+  exla::ExlaDevice* device = (*client)->device(device_ordinal);
+
+  EXLA_ASSIGN_OR_RETURN_NIF(xla::Literal literal,
+    device->TransferFromOutfeed(*shape), env);
+
+  ErlNifBinary binary;
+  enif_alloc_binary(literal.size_bytes(), &binary);
+  std::memcpy(binary.data, literal.untyped_data(), literal.size_bytes());
+
+  return exla::nif::ok(env, exla::nif::make(env, binary));
+}
+
 ERL_NIF_TERM deallocate_device_mem(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   if (argc != 1) {
     return exla::nif::error(env, "Bad argument count.");
@@ -407,6 +485,32 @@ ERL_NIF_TERM conditional_multi(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv
   return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
 }
 
+// Loops
+
+ERL_NIF_TERM while_loop(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 3) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaComputation* cond_comp;
+  xla::XlaComputation* body_comp;
+  xla::XlaOp* init;
+
+  if (!exla::nif::get<xla::XlaComputation>(env, argv[0], cond_comp)) {
+    return exla::nif::error(env, "Unable to get condition computation.");
+  }
+  if (!exla::nif::get<xla::XlaComputation>(env, argv[1], body_comp)) {
+    return exla::nif::error(env, "Unable to get body computation.");
+  }
+  if (!exla::nif::get<xla::XlaOp>(env, argv[2], init)) {
+    return exla::nif::error(env, "Unable to get initial value.");
+  }
+
+  xla::XlaOp op = xla::While(*cond_comp, *body_comp, *init);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
 ERL_NIF_TERM select(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   if (argc != 3) {
     return exla::nif::error(env, "Bad argument count.");
@@ -509,6 +613,266 @@ ERL_NIF_TERM dynamic_update_slice(ErlNifEnv* env, int argc, const ERL_NIF_TERM a
   return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
 }
 
+ERL_NIF_TERM gather(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 5) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  xla::XlaOp* start_indices;
+  xla::GatherDimensionNumbers dimension_numbers;
+  std::vector<exla::int64> slice_sizes;
+  bool indices_are_sorted;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get<xla::XlaOp>(env, argv[1], start_indices)) {
+    return exla::nif::error(env, "Unable to get start indices.");
+  }
+  if (!exla::nif::get_gather_dimension_numbers(env, argv[2], &dimension_numbers)) {
+    return exla::nif::error(env, "Unable to get dimension numbers.");
+  }
+  if (!exla::nif::get_list(env, argv[3], slice_sizes)) {
+    return exla::nif::error(env, "Unable to get slice sizes.");
+  }
+  if (!exla::nif::get(env, argv[4], &indices_are_sorted)) {
+    return exla::nif::error(env, "Unable to get indices are sorted flag.");
+  }
+
+  xla::XlaOp op = xla::Gather(*operand, *start_indices, dimension_numbers,
+                              slice_sizes, indices_are_sorted);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM scatter(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 7) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  xla::XlaOp* scatter_indices;
+  xla::XlaOp* updates;
+  xla::XlaComputation* update_computation;
+  xla::ScatterDimensionNumbers dimension_numbers;
+  bool indices_are_sorted;
+  bool unique_indices;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get<xla::XlaOp>(env, argv[1], scatter_indices)) {
+    return exla::nif::error(env, "Unable to get scatter indices.");
+  }
+  if (!exla::nif::get<xla::XlaOp>(env, argv[2], updates)) {
+    return exla::nif::error(env, "Unable to get updates.");
+  }
+  if (!exla::nif::get<xla::XlaComputation>(env, argv[3], update_computation)) {
+    return exla::nif::error(env, "Unable to get update computation.");
+  }
+  if (!exla::nif::get_scatter_dimension_numbers(env, argv[4], &dimension_numbers)) {
+    return exla::nif::error(env, "Unable to get dimension numbers.");
+  }
+  if (!exla::nif::get(env, argv[5], &indices_are_sorted)) {
+    return exla::nif::error(env, "Unable to get indices are sorted flag.");
+  }
+  if (!exla::nif::get(env, argv[6], &unique_indices)) {
+    return exla::nif::error(env, "Unable to get unique indices flag.");
+  }
+
+  xla::XlaOp op = xla::Scatter(*operand, *scatter_indices, *updates,
+                               *update_computation, dimension_numbers,
+                               indices_are_sorted, unique_indices);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+// Collectives
+
+ERL_NIF_TERM all_reduce(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 3) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  xla::XlaComputation* computation;
+  std::vector<xla::ReplicaGroup> replica_groups;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get<xla::XlaComputation>(env, argv[1], computation)) {
+    return exla::nif::error(env, "Unable to get computation.");
+  }
+  if (!exla::nif::get_replica_groups(env, argv[2], replica_groups)) {
+    return exla::nif::error(env, "Unable to get replica groups.");
+  }
+
+  xla::XlaOp op = xla::AllReduce(*operand, *computation, replica_groups);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM all_gather(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 4) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  exla::int64 all_gather_dimension;
+  exla::int64 shard_count;
+  std::vector<xla::ReplicaGroup> replica_groups;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get(env, argv[1], &all_gather_dimension)) {
+    return exla::nif::error(env, "Unable to get all gather dimension.");
+  }
+  if (!exla::nif::get(env, argv[2], &shard_count)) {
+    return exla::nif::error(env, "Unable to get shard count.");
+  }
+  if (!exla::nif::get_replica_groups(env, argv[3], replica_groups)) {
+    return exla::nif::error(env, "Unable to get replica groups.");
+  }
+
+  xla::XlaOp op = xla::AllGather(*operand, all_gather_dimension,
+                                 shard_count, replica_groups);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM all_to_all(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 5) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  exla::int64 split_dimension;
+  exla::int64 concat_dimension;
+  exla::int64 split_count;
+  std::vector<xla::ReplicaGroup> replica_groups;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get(env, argv[1], &split_dimension)) {
+    return exla::nif::error(env, "Unable to get split dimension.");
+  }
+  if (!exla::nif::get(env, argv[2], &concat_dimension)) {
+    return exla::nif::error(env, "Unable to get concat dimension.");
+  }
+  if (!exla::nif::get(env, argv[3], &split_count)) {
+    return exla::nif::error(env, "Unable to get split count.");
+  }
+  if (!exla::nif::get_replica_groups(env, argv[4], replica_groups)) {
+    return exla::nif::error(env, "Unable to get replica groups.");
+  }
+
+  xla::XlaOp op = xla::AllToAll(*operand, split_dimension, concat_dimension,
+                                split_count, replica_groups);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM collective_permute(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  std::vector<std::pair<exla::int64, exla::int64>> source_target_pairs;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get_source_target_pairs(env, argv[1], source_target_pairs)) {
+    return exla::nif::error(env, "Unable to get source target pairs.");
+  }
+
+  xla::XlaOp op = xla::CollectivePermute(*operand, source_target_pairs);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM replica_id(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 1) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaBuilder** builder;
+
+  if (!exla::nif::get<xla::XlaBuilder*>(env, argv[0], builder)) {
+    return exla::nif::error(env, "Unable to get builder.");
+  }
+
+  xla::XlaOp op = xla::ReplicaId(*builder);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+// Infeed/Outfeed
+
+ERL_NIF_TERM create_token(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 1) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaBuilder** builder;
+
+  if (!exla::nif::get<xla::XlaBuilder*>(env, argv[0], builder)) {
+    return exla::nif::error(env, "Unable to get builder.");
+  }
+
+  xla::XlaOp op = xla::CreateToken(*builder);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM infeed(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* token;
+  xla::Shape* shape;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], token)) {
+    return exla::nif::error(env, "Unable to get token.");
+  }
+  if (!exla::nif::get<xla::Shape>(env, argv[1], shape)) {
+    return exla::nif::error(env, "Unable to get shape.");
+  }
+
+  xla::XlaOp op = xla::InfeedWithToken(*token, *shape);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+ERL_NIF_TERM outfeed(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  xla::XlaOp* token;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get<xla::XlaOp>(env, argv[1], token)) {
+    return exla::nif::error(env, "Unable to get token.");
+  }
+
+  xla::XlaBuilder* builder = operand->builder();
+  EXLA_ASSIGN_OR_RETURN_NIF(xla::Shape shape, builder->GetShape(*operand), env);
+
+  xla::XlaOp op = xla::OutfeedWithToken(*operand, *token, shape, "");
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
 // Creation
 
 ERL_NIF_TERM rng_normal(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
@@ -869,6 +1233,180 @@ ERL_NIF_TERM population_count(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[
   return xla_unary_op(env, argc, argv, xla::PopulationCount);
 }
 
+// Fused element-wise ops
+//
+// Builds a whole element-wise expression from a postfix program
+// in a single NIF call. The program is a list of instructions
+// evaluated on a stack:
+//
+//   * {:operand, index} - pushes the operand at `index`
+//   * {:unary, name} - pops one value and pushes `name(value)`
+//   * {:binary, name, broadcast_dims} - pops the right and left
+//     values and pushes `name(left, right, broadcast_dims)`
+//
+// The program must leave exactly one value on the stack.
+
+typedef xla::XlaOp(*UnaryOpFn)(xla::XlaOp);
+typedef xla::XlaOp(*BinaryOpFn)(xla::XlaOp, xla::XlaOp, absl::Span<const exla::int64>);
+
+static const std::map<std::string, UnaryOpFn>& unary_ops() {
+  static const std::map<std::string, UnaryOpFn> ops = {
+    {"abs", xla::Abs},
+    {"exp", xla::Exp},
+    {"expm1", xla::Expm1},
+    {"floor", xla::Floor},
+    {"ceil", xla::Ceil},
+    {"round", xla::Round},
+    {"log", xla::Log},
+    {"log1p", xla::Log1p},
+    {"logistic", xla::Logistic},
+    {"sign", xla::Sign},
+    {"cos", xla::Cos},
+    {"sin", xla::Sin},
+    {"acos", xla::Acos},
+    {"asin", xla::Asin},
+    {"atan", xla::Atan},
+    {"cosh", xla::Cosh},
+    {"sinh", xla::Sinh},
+    {"tanh", xla::Tanh},
+    {"acosh", xla::Acosh},
+    {"asinh", xla::Asinh},
+    {"atanh", xla::Atanh},
+    {"real", xla::Real},
+    {"imag", xla::Imag},
+    {"sqrt", xla::Sqrt},
+    {"rsqrt", xla::Rsqrt},
+    {"cbrt", xla::Cbrt},
+    {"erf", xla::Erf},
+    {"erfc", xla::Erfc},
+    {"erf_inv", xla::ErfInv},
+    {"is_finite", xla::IsFinite},
+    {"negate", xla::Neg},
+    {"conj", xla::Conj},
+    {"bitwise_not", xla::Not},
+    {"count_leading_zeros", xla::Clz},
+    {"population_count", xla::PopulationCount},
+  };
+  return ops;
+}
+
+static const std::map<std::string, BinaryOpFn>& binary_ops() {
+  static const std::map<std::string, BinaryOpFn> ops = {
+    {"add", xla::Add},
+    {"subtract", xla::Sub},
+    {"multiply", xla::Mul},
+    {"divide", xla::Div},
+    {"remainder", xla::Rem},
+    {"min", xla::Min},
+    {"max", xla::Max},
+    {"bitwise_and", xla::And},
+    {"bitwise_or", xla::Or},
+    {"bitwise_xor", xla::Xor},
+    {"left_shift", xla::ShiftLeft},
+    {"right_shift_logical", xla::ShiftRightLogical},
+    {"right_shift_arithmetic", xla::ShiftRightArithmetic},
+    {"power", xla::Pow},
+    {"complex", xla::Complex},
+    {"atan2", xla::Atan2},
+    {"equal", xla::Eq},
+    {"not_equal", xla::Ne},
+    {"greater", xla::Gt},
+    {"greater_equal", xla::Ge},
+    {"less", xla::Lt},
+    {"less_equal", xla::Le},
+  };
+  return ops;
+}
+
+ERL_NIF_TERM elementwise(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  std::vector<xla::XlaOp> operands;
+  unsigned int program_length;
+
+  if (!exla::nif::get_list<xla::XlaOp>(env, argv[0], operands)) {
+    return exla::nif::error(env, "Unable to get operands.");
+  }
+  if (!enif_get_list_length(env, argv[1], &program_length)) {
+    return exla::nif::error(env, "Unable to get program.");
+  }
+
+  std::vector<xla::XlaOp> stack;
+  stack.reserve(program_length);
+
+  ERL_NIF_TERM program = argv[1];
+  ERL_NIF_TERM head, tail;
+
+  while (enif_get_list_cell(env, program, &head, &tail)) {
+    const ERL_NIF_TERM* instruction;
+    int arity;
+    std::string kind;
+
+    if (!enif_get_tuple(env, head, &arity, &instruction) ||
+        arity < 2 ||
+        !exla::nif::get_atom(env, instruction[0], kind)) {
+      return exla::nif::error(env, "Unable to get instruction.");
+    }
+
+    if (kind == "operand" && arity == 2) {
+      int index;
+      if (!exla::nif::get(env, instruction[1], &index) ||
+          index < 0 || index >= static_cast<int>(operands.size())) {
+        return exla::nif::error(env, "Invalid operand index.");
+      }
+      stack.push_back(operands[index]);
+    } else if (kind == "unary" && arity == 2) {
+      std::string name;
+      if (!exla::nif::get_atom(env, instruction[1], name)) {
+        return exla::nif::error(env, "Unable to get unary op name.");
+      }
+
+      auto op = unary_ops().find(name);
+      if (op == unary_ops().end()) {
+        return exla::nif::error(env, ("Unknown unary op: " + name + ".").c_str());
+      }
+      if (stack.size() < 1) {
+        return exla::nif::error(env, "Stack underflow in element-wise program.");
+      }
+
+      stack.back() = op->second(stack.back());
+    } else if (kind == "binary" && arity == 3) {
+      std::string name;
+      std::vector<exla::int64> broadcast_dims;
+      if (!exla::nif::get_atom(env, instruction[1], name)) {
+        return exla::nif::error(env, "Unable to get binary op name.");
+      }
+      if (!exla::nif::get_tuple(env, instruction[2], broadcast_dims)) {
+        return exla::nif::error(env, "Unable to get broadcast dimensions.");
+      }
+
+      auto op = binary_ops().find(name);
+      if (op == binary_ops().end()) {
+        return exla::nif::error(env, ("Unknown binary op: " + name + ".").c_str());
+      }
+      if (stack.size() < 2) {
+        return exla::nif::error(env, "Stack underflow in element-wise program.");
+      }
+
+      xla::XlaOp rhs = stack.back();
+      stack.pop_back();
+      stack.back() = op->second(stack.back(), rhs, broadcast_dims);
+    } else {
+      return exla::nif::error(env, "Unknown instruction.");
+    }
+
+    program = tail;
+  }
+
+  if (stack.size() != 1) {
+    return exla::nif::error(env, "Element-wise program must leave exactly one value.");
+  }
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, stack.back()));
+}
+
 // Constants
 
 ERL_NIF_TERM constant_r0(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
@@ -1312,7 +1850,7 @@ ERL_NIF_TERM dot(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
 }
 
 ERL_NIF_TERM dot_general(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
-  if (argc != 4) {
+  if (argc != 5) {
     return exla::nif::error(env, "Bad argument count.");
   }
 
@@ -1320,6 +1858,7 @@ ERL_NIF_TERM dot_general(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   xla::XlaOp* rhs;
   xla::DotDimensionNumbers dnums;
   xla::PrecisionConfig config;
+  absl::optional<xla::PrimitiveType> preferred_element_type;
 
   if (!exla::nif::get<xla::XlaOp>(env, argv[0], lhs)) {
     return exla::nif::error(env, "Unable to get left-hand side operand.");
@@ -1333,8 +1872,17 @@ ERL_NIF_TERM dot_general(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   if (!exla::nif::get_precision_config(env, argv[3], 2, &config)) {
     return exla::nif::error(env, "Unable to get precision configuration.");
   }
+  // The preferred element type is given as nil when the result
+  // should have the type of the operands.
+  if (!enif_is_atom(env, argv[4])) {
+    xla::PrimitiveType type;
+    if (!exla::nif::get_primitive_type(env, argv[4], &type)) {
+      return exla::nif::error(env, "Unable to get preferred element type.");
+    }
+    preferred_element_type = type;
+  }
 
-  xla::XlaOp op = xla::DotGeneral(*lhs, *rhs, dnums, &config);
+  xla::XlaOp op = xla::DotGeneral(*lhs, *rhs, dnums, &config, preferred_element_type);
 
   return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
 }
@@ -1510,6 +2058,56 @@ ERL_NIF_TERM sort(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
 }
 
+ERL_NIF_TERM top_k(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaOp* operand;
+  exla::int64 k;
+
+  if (!exla::nif::get<xla::XlaOp>(env, argv[0], operand)) {
+    return exla::nif::error(env, "Unable to get operand.");
+  }
+  if (!exla::nif::get(env, argv[1], &k)) {
+    return exla::nif::error(env, "Unable to get k.");
+  }
+
+  xla::XlaOp op = xla::TopK(*operand, k);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
+// Custom Calls
+
+ERL_NIF_TERM custom_call(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 4) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaBuilder** builder;
+  std::string call_target_name;
+  std::vector<xla::XlaOp> operands;
+  xla::Shape* shape;
+
+  if (!exla::nif::get<xla::XlaBuilder*>(env, argv[0], builder)) {
+    return exla::nif::error(env, "Unable to get builder.");
+  }
+  if (!exla::nif::get(env, argv[1], call_target_name)) {
+    return exla::nif::error(env, "Unable to get call target name.");
+  }
+  if (!exla::nif::get_list<xla::XlaOp>(env, argv[2], operands)) {
+    return exla::nif::error(env, "Unable to get operands.");
+  }
+  if (!exla::nif::get<xla::Shape>(env, argv[3], shape)) {
+    return exla::nif::error(env, "Unable to get shape.");
+  }
+
+  xla::XlaOp op = xla::CustomCall(*builder, call_target_name, operands, *shape);
+
+  return exla::nif::ok(env, exla::nif::make<xla::XlaOp>(env, op));
+}
+
 // LinAlg Functions
 
 ERL_NIF_TERM cholesky(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
@@ -1896,6 +2494,68 @@ ERL_NIF_TERM compile(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   return exla::nif::ok(env, exla::nif::make<exla::ExlaExecutable*>(env, executable));
 }
 
+ERL_NIF_TERM get_metrics(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 1) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::ExlaClient** client;
+
+  if (!exla::nif::get<exla::ExlaClient*>(env, argv[0], client)) {
+    return exla::nif::error(env, "Unable to get client.");
+  }
+
+  ERL_NIF_TERM devices = enif_make_new_map(env);
+
+  for (auto& device : (*client)->devices()) {
+    ERL_NIF_TERM ordinal = exla::nif::make(env, device->device_ordinal());
+    enif_make_map_put(env, devices, ordinal, device->metrics()->ToTerm(env), &devices);
+  }
+
+  ERL_NIF_TERM metrics = enif_make_new_map(env);
+  enif_make_map_put(env, metrics, exla::nif::atom(env, "client"),
+                    (*client)->metrics()->ToTerm(env), &metrics);
+  enif_make_map_put(env, metrics, exla::nif::atom(env, "devices"), devices, &metrics);
+
+  return exla::nif::ok(env, metrics);
+}
+
+ERL_NIF_TERM start_trace(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 0) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::TraceRecorder::Get()->Start();
+
+  return exla::nif::ok(env);
+}
+
+ERL_NIF_TERM stop_trace(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 0) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::TraceRecorder::Get()->Stop();
+
+  return exla::nif::ok(env);
+}
+
+ERL_NIF_TERM dump_trace(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 0) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  std::string trace = exla::TraceRecorder::Get()->ToChromeTrace();
+
+  ErlNifBinary binary;
+  if (!enif_alloc_binary(trace.size(), &binary)) {
+    return exla::nif::error(env, "Unable to allocate trace binary.");
+  }
+  std::memcpy(binary.data, trace.data(), trace.size());
+
+  return exla::nif::ok(env, exla::nif::make(env, binary));
+}
+
 ERL_NIF_TERM await_streams(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   if (argc != 3) {
     return exla::nif::error(env, "Bad argument count.");
@@ -1941,7 +2601,7 @@ ERL_NIF_TERM await_streams(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[])
 // ExlaExecutable Functions
 
 ERL_NIF_TERM run(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
-  if (argc != 11) {
+  if (argc != 12) {
     return exla::nif::error(env, "Bad argument count.");
   }
 
@@ -1955,6 +2615,7 @@ ERL_NIF_TERM run(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   int partition;
   bool async_run;
   bool keep_on_device;
+  bool profile;
 
   ERL_NIF_TERM arguments = argv[2];
 
@@ -1988,48 +2649,92 @@ ERL_NIF_TERM run(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
   if (!exla::nif::get(env, argv[10], &keep_on_device)) {
     return exla::nif::error(env, "Unable to get keep on device flag.");
   }
+  if (!exla::nif::get(env, argv[11], &profile)) {
+    return exla::nif::error(env, "Unable to get profile flag.");
+  }
 
   EXLA_ASSIGN_OR_RETURN_NIF(ERL_NIF_TERM term,
     (*executable)->Run(env, arguments, *output_shape,
                        replica, partition,
                        run_id, rng_seed,
-                       launch_id, async_run, keep_on_device), env);
+                       launch_id, async_run, keep_on_device,
+                       profile), env);
 
   return term;
 }
 
+ERL_NIF_TERM get_cost_analysis(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  exla::ExlaExecutable** executable;
+  int partition;
+
+  if (!exla::nif::get<exla::ExlaExecutable*>(env, argv[0], executable)) {
+    return exla::nif::error(env, "Unable to get executable.");
+  }
+  if (!exla::nif::get(env, argv[1], &partition)) {
+    return exla::nif::error(env, "Unable to get partition.");
+  }
+
+  std::map<std::string, double> cost;
+
+  EXLA_ASSIGN_OR_RETURN_NIF(cost, (*executable)->CostAnalysis(partition), env);
+
+  return exla::nif::ok(env, exla::nif::make_map(env, cost));
+}
+
 // Logging Functions
 
+// The sink currently installed, if any. It is replaced
+// whenever the logger process restarts.
+static exla::ExlaLogSink* current_log_sink = nullptr;
+
 ERL_NIF_TERM start_log_sink(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
-  if (argc != 1) {
+  if (argc != 3) {
     return exla::nif::make(env, "Bad argument count.");
   }
 
   ErlNifPid logger_pid;
+  int min_severity;
+  int max_per_second;
 
   if (!enif_get_local_pid(env, argv[0], &logger_pid)) {
     return exla::nif::error(env, "Unable to get logger pid");
   }
+  if (!exla::nif::get(env, argv[1], &min_severity)) {
+    return exla::nif::error(env, "Unable to get minimum severity.");
+  }
+  if (!exla::nif::get(env, argv[2], &max_per_second)) {
+    return exla::nif::error(env, "Unable to get maximum messages per second.");
+  }
 
-  exla::ExlaLogSink* sink = new exla::ExlaLogSink(logger_pid);
+  exla::ExlaLogSink* sink =
+    new exla::ExlaLogSink(logger_pid, min_severity, max_per_second);
 
   // NO_DEFAULT_LOGGER doesn't behave right
   for (auto *log_sink : tensorflow::TFGetLogSinks()) {
     tensorflow::TFRemoveLogSink(log_sink);
   }
 
+  // Sinks are only called while registered, so once removed
+  // the previous sink can be stopped and freed
+  delete current_log_sink;
+  current_log_sink = sink;
+
   tensorflow::TFAddLogSink(sink);
 
   return exla::nif::ok(env);
 }
 
 ERL_NIF_TERM compile_aot(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]){
-  if (argc != 8) {
+  if (argc != 9) {
     return exla::nif::error(env, "Bad argument count.");
   }
 
   xla::XlaComputation* computation;
-  std::string function_name, pbtext_path, header_path, object_path, class_name, target_triple, target_features;
+  std::string function_name, pbtext_path, header_path, object_path, class_name, target_triple, target_cpu, target_features;
 
   if (!exla::nif::get<xla::XlaComputation>(env, argv[0], computation)) {
     return exla::nif::error(env, "Unable to get computation.");
@@ -2052,7 +2757,10 @@ ERL_NIF_TERM compile_aot(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]){
   if (!exla::nif::get(env, argv[6], target_triple)) {
     return exla::nif::error(env, "Unable to get target triple.");
   }
-  if (!exla::nif::get(env, argv[7], target_features)) {
+  if (!exla::nif::get(env, argv[7], target_cpu)) {
+    return exla::nif::error(env, "Unable to get target cpu.");
+  }
+  if (!exla::nif::get(env, argv[8], target_features)) {
     return exla::nif::error(env, "Unable to get target features.");
   }
 
@@ -2064,6 +2772,7 @@ ERL_NIF_TERM compile_aot(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]){
                              function_name,
                              class_name,
                              target_triple,
+                             target_cpu,
                              target_features);
 
   if(!compile_status.ok()) {
@@ -2073,6 +2782,34 @@ ERL_NIF_TERM compile_aot(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]){
   return exla::nif::ok(env);
 }
 
+ERL_NIF_TERM run_hlo_passes(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+  if (argc != 2) {
+    return exla::nif::error(env, "Bad argument count.");
+  }
+
+  xla::XlaComputation* computation;
+  std::vector<std::string> pass_names;
+
+  if (!exla::nif::get<xla::XlaComputation>(env, argv[0], computation)) {
+    return exla::nif::error(env, "Unable to get computation.");
+  }
+  if (!exla::nif::get_list(env, argv[1], pass_names)) {
+    return exla::nif::error(env, "Unable to get pass names.");
+  }
+
+  exla::HloPassReport report;
+
+  EXLA_ASSIGN_OR_RETURN_NIF(xla::XlaComputation optimized,
+    exla::RunHloPasses(*computation, pass_names, &report), env);
+
+  ERL_NIF_TERM computation_term = exla::nif::make<xla::XlaComputation>(env, optimized);
+  ERL_NIF_TERM before_term = enif_make_int64(env, report.instructions_before);
+  ERL_NIF_TERM after_term = enif_make_int64(env, report.instructions_after);
+  ERL_NIF_TERM changed_term = exla::nif::atom(env, report.changed ? "true" : "false");
+
+  return exla::nif::ok(env, enif_make_tuple4(env, computation_term, before_term, after_term, changed_term));
+}
+
 static ErlNifFunc exla_funcs[] = {
   // XlaBuilder
   {"new_builder", 1, new_builder},
@@ -2086,6 +2823,10 @@ static ErlNifFunc exla_funcs[] = {
   {"get_device_count", 1, get_device_count},
   {"get_default_device_ordinal", 1, get_default_device_ordinal},
   {"get_supported_platforms", 0, get_supported_platforms},
+  {"get_metrics", 1, get_metrics},
+  {"start_trace", 0, start_trace},
+  {"stop_trace", 0, stop_trace},
+  {"dump_trace", 0, dump_trace, ERL_NIF_DIRTY_JOB_CPU_BOUND},
   {"compile", 6, compile, ERL_NIF_DIRTY_JOB_CPU_BOUND},
   {"await_streams_cpu", 3, await_streams, ERL_NIF_DIRTY_JOB_CPU_BOUND},
   {"await_streams_io", 3, await_streams, ERL_NIF_DIRTY_JOB_IO_BOUND},
@@ -2093,9 +2834,12 @@ static ErlNifFunc exla_funcs[] = {
   {"binary_to_device_mem", 4, binary_to_device_mem, ERL_NIF_DIRTY_JOB_IO_BOUND},
   {"read_device_mem", 2, read_device_mem, ERL_NIF_DIRTY_JOB_IO_BOUND},
   {"deallocate_device_mem", 1, deallocate_device_mem, ERL_NIF_DIRTY_JOB_IO_BOUND},
+  {"transfer_to_infeed", 4, transfer_to_infeed, ERL_NIF_DIRTY_JOB_IO_BOUND},
+  {"transfer_from_outfeed", 3, transfer_from_outfeed, ERL_NIF_DIRTY_JOB_IO_BOUND},
   // ExlaExecutable
-  {"run_io", 11, run, ERL_NIF_DIRTY_JOB_IO_BOUND},
-  {"run_cpu", 11, run, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+  {"run_io", 12, run, ERL_NIF_DIRTY_JOB_IO_BOUND},
+  {"run_cpu", 12, run, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+  {"get_cost_analysis", 2, get_cost_analysis, ERL_NIF_DIRTY_JOB_CPU_BOUND},
   // Shape
   {"make_shape", 2, make_shape},
   {"make_tuple_shape", 1, make_tuple_shape},
@@ -2160,6 +2904,8 @@ static ErlNifFunc exla_funcs[] = {
   {"bitwise_not", 1, bitwise_not},
   {"count_leading_zeros", 1, clz},
   {"population_count", 1, population_count},
+  // Fused element-wise
+  {"elementwise", 2, elementwise},
   // Constant Creation
   {"constant_r0", 3, constant_r0},
   {"constant_from_binary", 3, constant_from_binary},
@@ -2169,11 +2915,24 @@ static ErlNifFunc exla_funcs[] = {
   // Conditionals
   {"conditional", 5, conditional_if},
   {"conditional", 3, conditional_multi},
+  {"while", 3, while_loop},
   {"select", 3, select},
   // Slicing
   {"slice", 4, slice},
   {"dynamic_slice", 3, dynamic_slice},
   {"dynamic_update_slice", 3, dynamic_update_slice},
+  {"gather", 5, gather},
+  {"scatter", 7, scatter},
+  // Collectives
+  {"all_reduce", 3, all_reduce},
+  {"all_gather", 4, all_gather},
+  {"all_to_all", 5, all_to_all},
+  {"collective_permute", 2, collective_permute},
+  {"replica_id", 1, replica_id},
+  // Infeed/Outfeed
+  {"create_token", 1, create_token},
+  {"infeed", 2, infeed},
+  {"outfeed", 2, outfeed},
   // Tensor Creation
   {"rng_normal", 3, rng_normal},
   {"rng_uniform", 3, rng_uniform},
@@ -2193,13 +2952,15 @@ static ErlNifFunc exla_funcs[] = {
   {"transpose", 2, transpose},
   // Other
   {"dot", 3, dot},
-  {"dot_general", 4, dot_general},
+  {"dot_general", 5, dot_general},
   {"conv_general_dilated", 10, conv_general_dilated},
   {"pad", 3, pad},
   {"clamp", 3, clamp},
   {"reverse", 2, reverse},
   {"concatenate", 3, concatenate},
   {"sort", 3, sort},
+  {"top_k", 2, top_k},
+  {"custom_call", 4, custom_call},
   // LinAlg
   {"cholesky", 1, cholesky},
   {"eigh", 2, eigh},
@@ -2208,9 +2969,10 @@ static ErlNifFunc exla_funcs[] = {
   {"triangular_solve", 6, triangular_solve},
   {"svd", 2, svd},
   // Log Sink
-  {"start_log_sink", 1, start_log_sink},
+  {"start_log_sink", 3, start_log_sink},
   // HLO Functions
-  {"compile_aot", 8, compile_aot}
+  {"compile_aot", 9, compile_aot},
+  {"run_hlo_passes", 2, run_hlo_passes, ERL_NIF_DIRTY_JOB_CPU_BOUND}
 };
 
 ERL_NIF_INIT(Elixir.EXLA.NIF, exla_funcs, &load, NULL, NULL, NULL);
@@ -58,6 +58,7 @@ namespace exla {
                                  std::string function_name,
                                  std::string class_name,
                                  std::string target_triple,
+                                 std::string target_cpu,
                                  std::string target_features) {
 
     xla::Status compilation_status;
@@ -76,10 +77,11 @@ namespace exla {
 
     std::string entry_point = absl::StrCat("exla_", function_name, "_entry_point");
 
-    // These options are flags we can give to the user
+    // These options are flags we can give to the user. An empty
+    // `target_cpu` lets LLVM pick the generic CPU for the triple
     xla::cpu::CpuAotCompilationOptions aot_opts(
       target_triple,
-      /*target_cpu=*/"",
+      target_cpu,
       target_features,
       entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic
@@ -25,6 +25,7 @@ namespace exla{
                                  std::string function_name,
                                  std::string class_name,
                                  std::string target_triple,
+                                 std::string target_cpu,
                                  std::string target_features);
 
 }
\ No newline at end of file
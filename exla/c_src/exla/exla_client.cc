@@ -2,7 +2,9 @@
 #include "tensorflow/compiler/xla/exla/exla_allocator.h"
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 // TODO(seanmor5): Scrub some usages of `new`
 
@@ -143,6 +145,9 @@ xla::StatusOr<ERL_NIF_TERM> ExlaBuffer::ToBinary(ErlNifEnv* env) {
     return xla::FailedPrecondition("Attempt to read from deallocated buffer.");
   }
 
+  ScopedLatency latency(device_->metrics(), MetricPhase::kToBinary);
+  ScopedTrace trace("to_binary", "device_to_host", device_->device_ordinal());
+
   bool is_cpu_platform =
     (device_->executor()->platform()->id() ==
       stream_executor::host::kHostPlatformId);
@@ -229,6 +234,9 @@ ExlaBuffer::DecomposeBufferToTerm(ErlNifEnv* env,
                                   bool keep_on_device) {
   ERL_NIF_TERM term;
   if (!keep_on_device) {
+    ScopedLatency latency(buffer->device()->metrics(),
+                          MetricPhase::kDecomposeBufferToTerm);
+
     xla::ShapedBuffer shaped_buffer = buffer->AsShapedBuffer();
 
     xla::TransferManager* transfer_manager =
@@ -378,7 +386,8 @@ xla::StatusOr<ERL_NIF_TERM> ExlaExecutable::Run(ErlNifEnv* env,
                                                 int rng_seed,
                                                 int launch_id,
                                                 bool async_run,
-                                                bool keep_on_device) {
+                                                bool keep_on_device,
+                                                bool profile) {
   ExlaDevice* device;
   std::shared_ptr<xla::DeviceAssignment> device_assignment;
 
@@ -388,6 +397,12 @@ xla::StatusOr<ERL_NIF_TERM> ExlaExecutable::Run(ErlNifEnv* env,
   device_assignment = device_assignment_;
   int executable_idx = executables_.size() > 1 ? partition : 0;
 
+  std::shared_ptr<xla::LocalExecutable> executable =
+    executables_.at(executable_idx);
+
+  ScopedTrace trace("run", "compute", device->device_ordinal(),
+                    executable->executable()->module().name());
+
   xla::RunId run_id_obj(run_id);
   xla::ExecutableRunOptions run_options;
   run_options.set_stream(device->compute_stream());
@@ -400,17 +415,35 @@ xla::StatusOr<ERL_NIF_TERM> ExlaExecutable::Run(ErlNifEnv* env,
   run_options.set_gpu_executable_run_options(client_->gpu_run_options());
   run_options.set_launch_id(launch_id);
 
-  std::shared_ptr<xla::LocalExecutable> executable =
-    executables_.at(executable_idx);
+  // When profiling, XLA blocks on the stream after launching the
+  // computation, so the profile is filled in once RunAsync returns.
+  xla::ExecutionProfile execution_profile;
+  if (profile) {
+    run_options.set_execution_profile(&execution_profile);
+  }
 
-  EXLA_ASSIGN_OR_RETURN_NIF(std::vector<ExlaBuffer*> arguments,
-    UnpackRunArguments(env, argument_terms, device, client_, async_run), env);
+  ExlaMetrics* metrics = device->metrics();
+  std::vector<ExlaBuffer*> arguments;
+  std::vector<xla::ExecutionInput> inputs;
+  xla::StatusOr<xla::ExecutionOutput> run_result;
 
-  EXLA_ASSIGN_OR_RETURN_NIF(std::vector<xla::ExecutionInput> inputs,
-    PopulateInputBuffers(arguments), env);
+  {
+    ScopedLatency latency(metrics, MetricPhase::kUnpackRunArguments);
+    EXLA_ASSIGN_OR_RETURN_NIF(arguments,
+      UnpackRunArguments(env, argument_terms, device, client_, async_run), env);
+  }
 
-  EXLA_ASSIGN_OR_RETURN_NIF(xla::ExecutionOutput results,
-    executable->RunAsync(std::move(inputs), run_options), env);
+  {
+    ScopedLatency latency(metrics, MetricPhase::kPopulateInputBuffers);
+    EXLA_ASSIGN_OR_RETURN_NIF(inputs, PopulateInputBuffers(arguments), env);
+  }
+
+  {
+    ScopedLatency latency(metrics, MetricPhase::kRunAsync);
+    run_result = executable->RunAsync(std::move(inputs), run_options);
+  }
+
+  EXLA_ASSIGN_OR_RETURN_NIF(xla::ExecutionOutput results, std::move(run_result), env);
 
   xla::ScopedShapedBuffer result_buffer = results.ConsumeResult();
 
@@ -421,20 +454,68 @@ xla::StatusOr<ERL_NIF_TERM> ExlaExecutable::Run(ErlNifEnv* env,
                                        ExlaBuffer::BufferType::kReference);
 
   ERL_NIF_TERM device_ordinal = nif::make(env, device->device_ordinal());
+  ERL_NIF_TERM term;
 
   if (!async_run) {
-    device->compute_stream()->BlockHostUntilDone();
+    {
+      ScopedLatency latency(metrics, MetricPhase::kBlockHostUntilDone);
+      device->compute_stream()->BlockHostUntilDone();
+    }
 
-    EXLA_ASSIGN_OR_RETURN_NIF(ERL_NIF_TERM term,
+    EXLA_ASSIGN_OR_RETURN_NIF(term,
       ExlaBuffer::DecomposeBufferToTerm(env, buffer_ref, keep_on_device), env);
 
     if (!keep_on_device) {
       delete buffer_ref;
     }
-    return nif::ok(env, enif_make_tuple2(env, term, device_ordinal));
+  } else {
+    term = nif::make<ExlaBuffer*>(env, buffer_ref);
   }
 
-  return nif::ok(env, enif_make_tuple2(env, nif::make<ExlaBuffer*>(env, buffer_ref), device_ordinal));
+  if (profile) {
+    std::map<std::string, double> profile_info = {
+      {"compute_time_ns", static_cast<double>(execution_profile.compute_time_ns())},
+      {"compute_cycle_count", static_cast<double>(execution_profile.compute_cycle_count())},
+      {"compute_and_transfer_time_ns",
+        static_cast<double>(execution_profile.compute_and_transfer_time_ns())},
+    };
+
+    return nif::ok(env, enif_make_tuple3(env, term, device_ordinal, nif::make_map(env, profile_info)));
+  }
+
+  return nif::ok(env, enif_make_tuple2(env, term, device_ordinal));
+}
+
+xla::StatusOr<std::map<std::string, double>>
+ExlaExecutable::CostAnalysis(int partition) {
+  // Executables are picked as in Run, so both refer to the same one
+  int executable_idx = executables_.size() > 1 ? partition : 0;
+
+  if (executable_idx < 0 || executable_idx >= executables_.size()) {
+    return xla::InvalidArgument("Invalid partition %d.", partition);
+  }
+
+  const xla::HloModule& module =
+    executables_.at(executable_idx)->executable()->module();
+
+  xla::HloCostAnalysis analysis([](const xla::Shape& shape) {
+    return xla::ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+  });
+
+  xla::Status status = module.entry_computation()->Accept(&analysis);
+
+  if (!status.ok()) {
+    return status;
+  }
+
+  std::map<std::string, double> cost = {
+    {"flops", analysis.flop_count()},
+    {"transcendentals", analysis.transcendental_count()},
+    {"bytes_accessed", analysis.bytes_accessed()},
+    {"optimal_seconds", analysis.optimal_seconds()},
+  };
+
+  return cost;
 }
 
 // ExlaClient Functions
@@ -486,6 +567,8 @@ ExlaClient::BufferFromBinary(const ErlNifBinary& binary,
                              ExlaDevice* device,
                              bool transfer_for_run,
                              bool async_run) {
+  ScopedTrace trace("buffer_from_binary", "host_to_device", device->device_ordinal());
+
   int64 size = xla::ShapeUtil::ByteSizeOf(on_host_shape);
   if (size != binary.size) {
     return xla::InvalidArgument("Expected %d bytes from binary but got %d.",
@@ -548,6 +631,9 @@ ExlaClient::Compile(const xla::XlaComputation& computation,
                     std::vector<xla::Shape*> argument_layouts,
                     xla::ExecutableBuildOptions& options,
                     bool compile_portable_executable) {
+  ScopedLatency latency(metrics(), MetricPhase::kCompile);
+  ScopedTrace trace("compile", "", -1, computation.name());
+
   if (!options.device_allocator()) {
     options.set_device_allocator(allocator());
   }
@@ -1,11 +1,15 @@
 #ifndef EXLA_CLIENT_H_
 #define EXLA_CLIENT_H_
 
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 #include <utility>
 
 #include "tensorflow/compiler/xla/exla/exla_device.h"
+#include "tensorflow/compiler/xla/exla/exla_metrics.h"
+#include "tensorflow/compiler/xla/exla/exla_trace.h"
 #include "tensorflow/compiler/xla/exla/exla_nif_util.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -264,11 +268,17 @@ class ExlaExecutable {
   xla::StatusOr<std::vector<xla::ExecutionInput>>
   PopulateInputBuffers(absl::Span<ExlaBuffer* const> argument_handles);
 
+  // Runs XLA's cost analysis over the entry computation of the
+  // executable for the given partition, returning estimates such
+  // as the number of flops and bytes accessed.
+  xla::StatusOr<std::map<std::string, double>> CostAnalysis(int partition);
+
   // Runs the executable with the given configuration options. If
   // `keep_on_device` is true, the resulting term will be a reference
   // of a list of references to the underlying buffer(s). Otherwise,
   // the resulting buffer is decomposed to an Erlang term and the device
-  // memory is deallocated.
+  // memory is deallocated. If `profile` is true, the execution profile
+  // is collected and returned as a map alongside the result.
   xla::StatusOr<ERL_NIF_TERM> Run(ErlNifEnv* env,
                                   ERL_NIF_TERM arguments,
                                   xla::Shape& output_shape,
@@ -278,7 +288,8 @@ class ExlaExecutable {
                                   int rng_seed,
                                   int launch_id,
                                   bool async_run,
-                                  bool keep_on_device);
+                                  bool keep_on_device,
+                                  bool profile);
 
  private:
   ExlaClient* client_;
@@ -366,6 +377,10 @@ class ExlaClient {
   // Returns a single device from the given `id`.
   exla::ExlaDevice* device(int id) { return devices_.at(id).get(); }
 
+  // Returns the client's latency metrics for compilation. Run
+  // and transfer metrics are kept per device.
+  ExlaMetrics* metrics() { return &metrics_; }
+
  private:
   xla::LocalClient* client_;
   std::unique_ptr<tensorflow::Allocator> host_memory_allocator_;
@@ -374,6 +389,7 @@ class ExlaClient {
   std::unique_ptr<se::DeviceMemoryAllocator> owned_allocator_;
   std::unique_ptr<xla::gpu::GpuExecutableRunOptions> gpu_run_options_;
   std::vector<std::unique_ptr<ExlaDevice>> devices_;
+  ExlaMetrics metrics_;
 };
 
 // TODO(seanmor5): Separate into different device classes similar to PjRt
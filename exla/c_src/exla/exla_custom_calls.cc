@@ -0,0 +1,160 @@
+#include "tensorflow/compiler/xla/exla/exla_custom_calls.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
+
+namespace exla {
+
+// Float reductions are only vectorized by compilers when they may
+// reassociate them (-ffast-math), which XLA is not built with. So the
+// reductions below keep kLanes independent accumulators, which map
+// onto SIMD registers as is, and are combined at the end. std::exp
+// has no vector version in the standard library and stays scalar.
+constexpr int64_t kLanes = 8;
+
+static float Max(const float* x, int64_t n) {
+  float lanes[kLanes];
+  std::fill(lanes, lanes + kLanes, -INFINITY);
+
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64_t j = 0; j < kLanes; j++) {
+      lanes[j] = lanes[j] > x[i + j] ? lanes[j] : x[i + j];
+    }
+  }
+
+  float max = *std::max_element(lanes, lanes + kLanes);
+  for (; i < n; i++) {
+    max = max > x[i] ? max : x[i];
+  }
+  return max;
+}
+
+static float Sum(const float* x, int64_t n) {
+  float lanes[kLanes] = {0.0f};
+
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64_t j = 0; j < kLanes; j++) {
+      lanes[j] += x[i + j];
+    }
+  }
+
+  float sum = std::accumulate(lanes, lanes + kLanes, 0.0f);
+  for (; i < n; i++) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+static float SumOfSquares(const float* x, float mean, int64_t n) {
+  float lanes[kLanes] = {0.0f};
+
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64_t j = 0; j < kLanes; j++) {
+      float centered = x[i + j] - mean;
+      lanes[j] += centered * centered;
+    }
+  }
+
+  float sum = std::accumulate(lanes, lanes + kLanes, 0.0f);
+  for (; i < n; i++) {
+    float centered = x[i] - mean;
+    sum += centered * centered;
+  }
+  return sum;
+}
+
+extern "C" void exla_top_k_f32(void* out, const void** in) {
+  int64_t batch = *reinterpret_cast<const int64_t*>(in[0]);
+  int64_t n = *reinterpret_cast<const int64_t*>(in[1]);
+  int64_t k = *reinterpret_cast<const int64_t*>(in[2]);
+  const float* x = reinterpret_cast<const float*>(in[3]);
+
+  void** outs = reinterpret_cast<void**>(out);
+  float* values = reinterpret_cast<float*>(outs[0]);
+  int32_t* indices = reinterpret_cast<int32_t*>(outs[1]);
+
+  std::vector<int32_t> order(n);
+
+  for (int64_t b = 0; b < batch; b++) {
+    const float* row = x + b * n;
+    std::iota(order.begin(), order.end(), 0);
+
+    // Partial selection is O(n log k). Ties keep the lowest index
+    // and NaNs are ranked first, like a descending total order.
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      [row](int32_t i, int32_t j) {
+                        float a = row[i], c = row[j];
+                        if (std::isnan(a) || std::isnan(c)) {
+                          return std::isnan(a) && (!std::isnan(c) || i < j);
+                        }
+                        return a > c || (a == c && i < j);
+                      });
+
+    for (int64_t i = 0; i < k; i++) {
+      values[b * k + i] = row[order[i]];
+      indices[b * k + i] = order[i];
+    }
+  }
+}
+
+extern "C" void exla_softmax_f32(void* out, const void** in) {
+  int64_t batch = *reinterpret_cast<const int64_t*>(in[0]);
+  int64_t n = *reinterpret_cast<const int64_t*>(in[1]);
+  const float* x = reinterpret_cast<const float*>(in[2]);
+  float* y = reinterpret_cast<float*>(out);
+
+  for (int64_t b = 0; b < batch; b++) {
+    const float* row = x + b * n;
+    float* result = y + b * n;
+
+    float max = Max(row, n);
+
+    for (int64_t i = 0; i < n; i++) {
+      result[i] = std::exp(row[i] - max);
+    }
+
+    float scale = 1.0f / Sum(result, n);
+    for (int64_t i = 0; i < n; i++) {
+      result[i] *= scale;
+    }
+  }
+}
+
+extern "C" void exla_layer_norm_f32(void* out, const void** in) {
+  int64_t batch = *reinterpret_cast<const int64_t*>(in[0]);
+  int64_t n = *reinterpret_cast<const int64_t*>(in[1]);
+  float epsilon = *reinterpret_cast<const float*>(in[2]);
+  const float* x = reinterpret_cast<const float*>(in[3]);
+  const float* gamma = reinterpret_cast<const float*>(in[4]);
+  const float* beta = reinterpret_cast<const float*>(in[5]);
+  float* y = reinterpret_cast<float*>(out);
+
+  for (int64_t b = 0; b < batch; b++) {
+    const float* row = x + b * n;
+    float* result = y + b * n;
+
+    float mean = Sum(row, n) / n;
+    float inv_std = 1.0f / std::sqrt(SumOfSquares(row, mean, n) / n + epsilon);
+
+    for (int64_t i = 0; i < n; i++) {
+      result[i] = (row[i] - mean) * inv_std * gamma[i] + beta[i];
+    }
+  }
+}
+
+void RegisterCustomCallTargets() {
+  xla::CustomCallTargetRegistry* registry = xla::CustomCallTargetRegistry::Global();
+  registry->Register("exla_top_k_f32", reinterpret_cast<void*>(exla_top_k_f32), "Host");
+  registry->Register("exla_softmax_f32", reinterpret_cast<void*>(exla_softmax_f32), "Host");
+  registry->Register("exla_layer_norm_f32", reinterpret_cast<void*>(exla_layer_norm_f32), "Host");
+}
+
+}  // namespace exla
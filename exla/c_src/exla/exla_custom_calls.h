@@ -0,0 +1,29 @@
+#ifndef EXLA_CUSTOM_CALLS_H_
+#define EXLA_CUSTOM_CALLS_H_
+
+namespace exla {
+
+// Hand-written host kernels, registered as XLA custom call targets
+// for the Host platform. They follow the CPU custom call calling
+// convention, `void(void* out, const void** in)`, where `out` is
+// an array of result pointers if the result shape is a tuple.
+//
+// Kernels operate on row-major f32 data seen as a `[batch, n]`
+// matrix. The dimensions, and any other scalar attributes, are
+// given as leading scalar operands:
+//
+//   * exla_top_k_f32 - in: (s64 batch, s64 n, s64 k, f32 x[batch, n])
+//     out: (f32 values[batch, k], s32 indices[batch, k])
+//
+//   * exla_softmax_f32 - in: (s64 batch, s64 n, f32 x[batch, n])
+//     out: f32[batch, n]
+//
+//   * exla_layer_norm_f32 - in: (s64 batch, s64 n, f32 epsilon,
+//     f32 x[batch, n], f32 gamma[n], f32 beta[n])
+//     out: f32[batch, n]
+//
+void RegisterCustomCallTargets();
+
+}  // namespace exla
+
+#endif
@@ -1,4 +1,6 @@
 #include "tensorflow/compiler/xla/exla/exla_device.h"
+#include "tensorflow/compiler/xla/exla/exla_trace.h"
+#include "tensorflow/compiler/xla/service/transfer_manager.h"
 
 namespace exla {
 
@@ -18,6 +20,7 @@ namespace exla {
   }
 
   xla::Status ExlaDevice::SynchronizeAllActivity() {
+    ScopedTrace trace("synchronize_all_activity", "all", device_ordinal());
     xla::Status status;
     status.Update(compute_stream_->BlockHostUntilDone());
     status.Update(callback_stream_->BlockHostUntilDone());
@@ -28,4 +31,23 @@ namespace exla {
     return status;
   }
 
+  xla::Status ExlaDevice::TransferToInfeed(const xla::LiteralSlice& literal) {
+    ScopedTrace trace("transfer_to_infeed", "host_to_device", device_ordinal());
+    xla::TransferManager* transfer_manager =
+      client_->backend().transfer_manager();
+    return transfer_manager->TransferLiteralToInfeed(executor_, literal);
+  }
+
+  xla::StatusOr<xla::Literal> ExlaDevice::TransferFromOutfeed(const xla::Shape& shape) {
+    ScopedTrace trace("transfer_from_outfeed", "device_to_host", device_ordinal());
+    xla::TransferManager* transfer_manager =
+      client_->backend().transfer_manager();
+    xla::Literal literal(shape);
+    xla::Status status = transfer_manager->TransferLiteralFromOutfeed(executor_, &literal);
+    if (!status.ok()) {
+      return status;
+    }
+    return std::move(literal);
+  }
+
 }  // namespace exla
@@ -3,6 +3,7 @@
 
 #include <memory>
 
+#include "tensorflow/compiler/xla/exla/exla_metrics.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
 #include "tensorflow/stream_executor/stream_executor.h"
 
@@ -63,6 +64,18 @@ class ExlaDevice {
     // This function synchronizes streams on this device
     xla::Status SynchronizeAllActivity();
 
+    // Enqueues `literal` on this device's infeed queue, where it is
+    // consumed by the next Infeed op executed on this device. On the
+    // host platform the infeed is an in-process queue.
+    xla::Status TransferToInfeed(const xla::LiteralSlice& literal);
+
+    // Blocks until an Outfeed op on this device produces a value of
+    // `shape` and returns it.
+    xla::StatusOr<xla::Literal> TransferFromOutfeed(const xla::Shape& shape);
+
+    // Returns this device's latency metrics for runs and transfers.
+    ExlaMetrics* metrics() { return &metrics_; }
+
  private:
     int id_;
     se::StreamExecutor* const executor_;
@@ -71,6 +84,7 @@ class ExlaDevice {
     std::unique_ptr<se::Stream> host_to_device_stream_;
     std::unique_ptr<se::Stream> device_to_host_stream_;
     std::unique_ptr<se::Stream> callback_stream_;
+    ExlaMetrics metrics_;
 };
 }  // namespace exla
 
@@ -0,0 +1,78 @@
+#include "tensorflow/compiler/xla/exla/exla_hlo_passes.h"
+#include "tensorflow/compiler/xla/exla/exla_nif_util.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
+#include "tensorflow/compiler/xla/service/call_inliner.h"
+#include "tensorflow/compiler/xla/service/flatten_call_graph.h"
+#include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
+#include "tensorflow/compiler/xla/service/hlo_cse.h"
+#include "tensorflow/compiler/xla/service/hlo_dce.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
+#include "tensorflow/compiler/xla/service/reshape_mover.h"
+#include "tensorflow/compiler/xla/service/tuple_simplifier.h"
+#include "tensorflow/compiler/xla/service/while_loop_simplifier.h"
+
+namespace exla {
+
+static xla::Status AddPass(xla::HloPassPipeline* pipeline,
+                           const std::string& name) {
+  if (name == "algsimp") {
+    pipeline->AddPass<xla::AlgebraicSimplifier>(
+      xla::AlgebraicSimplifierOptions());
+  } else if (name == "constant_folding") {
+    pipeline->AddPass<xla::HloConstantFolding>();
+  } else if (name == "cse") {
+    pipeline->AddPass<xla::HloCSE>(/*is_layout_sensitive=*/false);
+  } else if (name == "dce") {
+    pipeline->AddPass<xla::HloDCE>();
+  } else if (name == "tuple-simplifier") {
+    pipeline->AddPass<xla::TupleSimplifier>();
+  } else if (name == "reshape-mover") {
+    pipeline->AddPass<xla::ReshapeMover>();
+  } else if (name == "simplify-while-loops") {
+    pipeline->AddPass<xla::WhileLoopSimplifier>();
+  } else if (name == "call-inliner") {
+    pipeline->AddPass<xla::CallInliner>();
+  } else if (name == "flatten-call-graph") {
+    pipeline->AddPass<xla::FlattenCallGraph>();
+  } else {
+    return xla::InvalidArgument("Unknown HLO pass: %s.", name);
+  }
+
+  return xla::Status::OK();
+}
+
+xla::StatusOr<xla::XlaComputation>
+RunHloPasses(const xla::XlaComputation& computation,
+             const std::vector<std::string>& pass_names,
+             HloPassReport* report) {
+  xla::HloPassPipeline pipeline("exla");
+
+  for (const std::string& name : pass_names) {
+    xla::Status status = AddPass(&pipeline, name);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  EXLA_ASSIGN_OR_RETURN(xla::ProgramShape program_shape,
+    computation.GetProgramShape());
+
+  xla::HloModuleConfig config(program_shape);
+  config.set_debug_options(xla::GetDebugOptionsFromFlags());
+
+  EXLA_ASSIGN_OR_RETURN(std::unique_ptr<xla::HloModule> module,
+    xla::HloModule::CreateFromProto(computation.proto(), config));
+
+  report->instructions_before = module->instruction_count();
+
+  EXLA_ASSIGN_OR_RETURN(report->changed, pipeline.Run(module.get()));
+
+  report->instructions_after = module->instruction_count();
+
+  return xla::XlaComputation(module->ToProto());
+}
+
+}  // namespace exla
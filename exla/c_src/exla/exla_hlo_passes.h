@@ -0,0 +1,32 @@
+#ifndef EXLA_HLO_PASSES_H_
+#define EXLA_HLO_PASSES_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace exla {
+
+// Summary of running a pass pipeline over a computation, used
+// to tell how much the given passes shrunk the module.
+struct HloPassReport {
+  tensorflow::int64 instructions_before;
+  tensorflow::int64 instructions_after;
+  bool changed;
+};
+
+// Runs the named HLO passes, in order, over the given computation
+// and returns the optimized computation. Pass names follow the ones
+// XLA uses for each pass, such as "algsimp", "constant_folding",
+// "cse" and "dce". Returns an error if a pass name is unknown.
+xla::StatusOr<xla::XlaComputation>
+RunHloPasses(const xla::XlaComputation& computation,
+             const std::vector<std::string>& pass_names,
+             HloPassReport* report);
+
+}  // namespace exla
+
+#endif
@@ -0,0 +1,181 @@
+#include "tensorflow/compiler/xla/exla/exla_log_sink.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace exla {
+
+constexpr std::chrono::milliseconds ExlaLogSink::kFlushInterval;
+constexpr int ExlaLogSink::kMaxBatchSize;
+
+ExlaLogSink::ExlaLogSink(ErlNifPid sink_pid,
+                         int min_severity,
+                         int max_per_second) : sink_pid_(sink_pid),
+                                               min_severity_(min_severity),
+                                               max_per_second_(max_per_second),
+                                               window_(0),
+                                               window_count_(0),
+                                               dropped_(0),
+                                               stopped_(false) {
+  env_ = enif_alloc_env();
+  stub_.next.store(nullptr, std::memory_order_relaxed);
+  head_.store(&stub_, std::memory_order_relaxed);
+  tail_ = &stub_;
+  thread_ = std::thread(&ExlaLogSink::Run, this);
+}
+
+ExlaLogSink::~ExlaLogSink() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_.store(true);
+  }
+  wakeup_.notify_one();
+  thread_.join();
+
+  while (Node* node = Pop()) delete node;
+  enif_free_env(env_);
+}
+
+void ExlaLogSink::Send(const tensorflow::TFLogEntry& entry) {
+  absl::LogSeverity severity = entry.log_severity();
+
+  if (severity == absl::LogSeverity::kFatal) {
+    // LOG(FATAL) aborts the program before we are able
+    // to send and log the information from Elixir, so we
+    // need to get it out there for debugging before everything
+    // crashes
+    std::cerr << "[FATAL] " << entry.FName() << ":"
+              << entry.Line() << " " << entry.ToString() << "\n";
+    return;
+  }
+
+  if (!Allow(severity)) return;
+
+  Node* node = new Node();
+  node->severity = severity;
+  node->msg = entry.ToString();
+  node->fname = entry.FName();
+  node->line = entry.Line();
+  Push(node);
+}
+
+bool ExlaLogSink::Allow(absl::LogSeverity severity) {
+  if (static_cast<int>(severity) < min_severity_) return false;
+
+  int64 now = std::chrono::duration_cast<std::chrono::seconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  int64 window = window_.load(std::memory_order_relaxed);
+  if (window != now && window_.compare_exchange_strong(window, now)) {
+    window_count_.store(0, std::memory_order_relaxed);
+  }
+
+  if (window_count_.fetch_add(1, std::memory_order_relaxed) >= max_per_second_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  return true;
+}
+
+void ExlaLogSink::Push(Node* node) {
+  node->next.store(nullptr, std::memory_order_relaxed);
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+}
+
+// Only called from the consumer thread (or after it stopped).
+// Returns nullptr if the queue is empty or if a producer is in
+// the middle of linking its node, which is picked up next flush.
+ExlaLogSink::Node* ExlaLogSink::Pop() {
+  Node* tail = tail_;
+  Node* next = tail->next.load(std::memory_order_acquire);
+
+  if (tail == &stub_) {
+    if (next == nullptr) return nullptr;
+    tail_ = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+
+  if (tail != head_.load(std::memory_order_acquire)) return nullptr;
+
+  // The tail is the last node, push the stub back so we can take it
+  Push(&stub_);
+  next = tail->next.load(std::memory_order_acquire);
+
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+
+  return nullptr;
+}
+
+void ExlaLogSink::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stopped_.load()) {
+    wakeup_.wait_for(lock, kFlushInterval);
+    lock.unlock();
+    Flush();
+    lock.lock();
+  }
+
+  lock.unlock();
+  Flush();
+}
+
+void ExlaLogSink::Flush() {
+  for (;;) {
+    std::vector<ERL_NIF_TERM> entries;
+
+    while (entries.size() < kMaxBatchSize) {
+      Node* node = Pop();
+      if (node == nullptr) break;
+
+      const char* severity;
+      switch (node->severity) {
+        case absl::LogSeverity::kWarning:
+          severity = "warning";
+          break;
+        case absl::LogSeverity::kError:
+          severity = "error";
+          break;
+        default:
+          severity = "info";
+          break;
+      }
+
+      entries.push_back(enif_make_tuple4(env_,
+                                         nif::atom(env_, severity),
+                                         nif::make(env_, node->msg),
+                                         nif::make(env_, node->fname),
+                                         nif::make(env_, node->line)));
+      delete node;
+    }
+
+    int dropped = dropped_.exchange(0, std::memory_order_relaxed);
+
+    if (entries.empty() && dropped == 0) return;
+
+    ERL_NIF_TERM batch = enif_make_list_from_array(env_, entries.data(), entries.size());
+    ERL_NIF_TERM msg = enif_make_tuple3(env_,
+                                        nif::atom(env_, "log_batch"),
+                                        batch,
+                                        nif::make(env_, dropped));
+
+    enif_send(NULL, &sink_pid_, env_, msg);
+    enif_clear_env(env_);
+
+    if (entries.size() < kMaxBatchSize) return;
+  }
+}
+
+}  // namespace exla
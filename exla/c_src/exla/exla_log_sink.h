@@ -1,7 +1,12 @@
 #ifndef EXLA_LOG_SINK_H_
 #define EXLA_LOG_SINK_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "tensorflow/compiler/xla/exla/exla_nif_util.h"
 #include "tensorflow/core/platform/logging.h"
@@ -10,73 +15,66 @@
 namespace exla {
 
 // Redirects calls to logging to the Elixir Logger. `sink_pid`
-// is the PID for a GenServer in Elixir which receives messages
-// with logging information on every call to `LOG(severity)`.
+// is the PID for a GenServer in Elixir which receives batches
+// of logging information.
+//
+// Logging threads only filter, rate limit and copy the entry into
+// a lock-free multi-producer single-consumer queue. A dedicated
+// thread drains the queue every `kFlushInterval`, builds the terms
+// in its own env and sends each batch as a single message:
+//
+//     {:log_batch, [{severity, msg, file, line}], dropped}
+//
+// where `dropped` is the number of entries discarded by the
+// rate limit since the last batch.
 class ExlaLogSink : public tensorflow::TFLogSink {
  public:
-  explicit ExlaLogSink(ErlNifPid sink_pid) : sink_pid_(sink_pid) {
-    // Logger Env
-    env_ = enif_alloc_env();
-  }
+  static constexpr std::chrono::milliseconds kFlushInterval{50};
+  static constexpr int kMaxBatchSize = 256;
 
-  ~ExlaLogSink() { enif_free_env(env_); }
+  // Entries below `min_severity` are discarded and at most
+  // `max_per_second` entries are forwarded every second.
+  ExlaLogSink(ErlNifPid sink_pid, int min_severity, int max_per_second);
 
-  ERL_NIF_TERM info(std::string str, std::string fname, int32 line) {
-    ERL_NIF_TERM status = nif::atom(env_, "info");
-    ERL_NIF_TERM msg = nif::make(env_, str);
-    ERL_NIF_TERM file = nif::make(env_, fname);
-    ERL_NIF_TERM line_term = nif::make(env_, line);
-    return enif_make_tuple4(env_, status, msg, file, line_term);
-  }
+  ~ExlaLogSink();
 
-  ERL_NIF_TERM warning(std::string str, std::string fname, int32 line) {
-    ERL_NIF_TERM status = nif::atom(env_, "warning");
-    ERL_NIF_TERM msg = nif::make(env_, str);
-    ERL_NIF_TERM file = nif::make(env_, fname);
-    ERL_NIF_TERM line_term = nif::make(env_, line);
-    return enif_make_tuple4(env_, status, msg, file, line_term);
-  }
+  void Send(const tensorflow::TFLogEntry& entry) override;
 
-  ERL_NIF_TERM error(std::string str, std::string fname, int32 line) {
-    ERL_NIF_TERM status = nif::atom(env_, "error");
-    ERL_NIF_TERM msg = nif::make(env_, str);
-    ERL_NIF_TERM file = nif::make(env_, fname);
-    ERL_NIF_TERM line_term = nif::make(env_, line);
-    return enif_make_tuple4(env_, status, msg, file, line_term);
-  }
+ private:
+  struct Node {
+    std::atomic<Node*> next;
+    absl::LogSeverity severity;
+    std::string msg;
+    std::string fname;
+    int32 line;
+  };
 
-  void Send(const tensorflow::TFLogEntry& entry) {
-    ERL_NIF_TERM msg;
-    std::string msg_str = entry.ToString();
-    std::string fname = entry.FName();
-    int32 line = entry.Line();
-    switch (entry.log_severity()) {
-      case absl::LogSeverity::kInfo:
-        msg = info(msg_str, fname, line);
-        break;
-      case absl::LogSeverity::kWarning:
-        msg = warning(msg_str, fname, line);
-        break;
-      case absl::LogSeverity::kError:
-        msg = error(msg_str, fname, line);
-        break;
-      case absl::LogSeverity::kFatal:
-        // LOG(FATAL) aborts the program before we are able
-        // to send and log the information from Elixir, so we
-        // need to get it out there for debugging before everything
-        // crashes
-        std::cerr << "[FATAL] " << fname << ":"
-                  << line << " " << msg_str << "\n";
-      default:
-        msg = info(msg_str, fname, line);
-        break;
-    }
-    enif_send(env_, &sink_pid_, NULL, msg);
-  }
+  bool Allow(absl::LogSeverity severity);
+  void Push(Node* node);
+  Node* Pop();
+  void Run();
+  void Flush();
 
- private:
   ErlNifPid sink_pid_;
   ErlNifEnv* env_;
+  int min_severity_;
+  int max_per_second_;
+
+  // Fixed window rate limiting
+  std::atomic<int64> window_;
+  std::atomic<int> window_count_;
+  std::atomic<int> dropped_;
+
+  // Intrusive MPSC queue: producers swap `head_`,
+  // the consumer thread walks from `tail_`.
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+
+  std::atomic<bool> stopped_;
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::thread thread_;
 };
 
 }  // namespace exla
@@ -0,0 +1,121 @@
+#include "tensorflow/compiler/xla/exla/exla_metrics.h"
+
+#include <vector>
+
+namespace exla {
+
+static const char* phase_names[] = {
+  "compile",
+  "unpack_run_arguments",
+  "populate_input_buffers",
+  "run_async",
+  "block_host_until_done",
+  "decompose_buffer_to_term",
+  "to_binary"
+};
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_(0), max_(0) {
+  for (int i = 0; i < kBuckets; i++) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return value;
+  }
+
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+
+  int shift = index / kSubBuckets - 1;
+  uint64_t sub_bucket = index % kSubBuckets;
+  uint64_t lower = (kSubBuckets + sub_bucket) << shift;
+  return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+  counts_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+ERL_NIF_TERM LatencyHistogram::ToTerm(ErlNifEnv* env) const {
+  // Buckets are read one by one while other threads may still be
+  // recording, so we compute the total from the buckets themselves
+  // to keep the percentiles consistent with the snapshot.
+  uint64_t snapshot[kBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    snapshot[i] = counts_[i].load(std::memory_order_relaxed);
+    total += snapshot[i];
+  }
+
+  const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+  const char* quantile_names[] = {"p50", "p90", "p99", "p999"};
+  uint64_t quantile_values[] = {0, 0, 0, 0};
+
+  std::vector<ERL_NIF_TERM> buckets;
+  uint64_t seen = 0;
+  int next_quantile = 0;
+
+  for (int i = 0; i < kBuckets; i++) {
+    if (snapshot[i] == 0) continue;
+
+    seen += snapshot[i];
+    uint64_t upper = BucketUpperBound(i);
+
+    while (next_quantile < 4 && seen >= quantiles[next_quantile] * total) {
+      quantile_values[next_quantile++] = upper;
+    }
+
+    buckets.push_back(enif_make_tuple2(env,
+                                       enif_make_uint64(env, upper),
+                                       enif_make_uint64(env, snapshot[i])));
+  }
+
+  ERL_NIF_TERM term = enif_make_new_map(env);
+  enif_make_map_put(env, term, nif::atom(env, "count"),
+                    enif_make_uint64(env, total), &term);
+  enif_make_map_put(env, term, nif::atom(env, "sum_ns"),
+                    enif_make_uint64(env, sum_.load(std::memory_order_relaxed)), &term);
+  enif_make_map_put(env, term, nif::atom(env, "max_ns"),
+                    enif_make_uint64(env, max_.load(std::memory_order_relaxed)), &term);
+
+  for (int i = 0; i < 4; i++) {
+    enif_make_map_put(env, term, nif::atom(env, quantile_names[i]),
+                      enif_make_uint64(env, quantile_values[i]), &term);
+  }
+
+  ERL_NIF_TERM bucket_list =
+    enif_make_list_from_array(env, buckets.data(), buckets.size());
+  enif_make_map_put(env, term, nif::atom(env, "buckets"), bucket_list, &term);
+
+  return term;
+}
+
+ERL_NIF_TERM ExlaMetrics::ToTerm(ErlNifEnv* env) const {
+  ERL_NIF_TERM term = enif_make_new_map(env);
+
+  for (int i = 0; i < static_cast<int>(MetricPhase::kNumPhases); i++) {
+    if (histograms_[i].empty()) continue;
+
+    ERL_NIF_TERM histogram = histograms_[i].ToTerm(env);
+    enif_make_map_put(env, term, nif::atom(env, phase_names[i]), histogram, &term);
+  }
+
+  return term;
+}
+
+}  // namespace exla
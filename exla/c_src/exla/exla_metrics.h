@@ -0,0 +1,93 @@
+#ifndef EXLA_METRICS_H_
+#define EXLA_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "tensorflow/compiler/xla/exla/exla_nif_util.h"
+
+namespace exla {
+
+// Lock-free latency histogram in the spirit of HdrHistogram.
+// Values are recorded in nanoseconds into log-linear buckets:
+// every power of two is split into `kSubBuckets` linear buckets,
+// which bounds the relative error of any reported value to 12.5%.
+// Recording is a handful of relaxed atomic operations, so it is
+// cheap enough to be always on.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram();
+
+  // Records a single value, in nanoseconds.
+  void Record(uint64_t value);
+
+  // Returns true if no values were recorded.
+  bool empty() const { return count_.load(std::memory_order_relaxed) == 0; }
+
+  // Returns a map with the count, sum, max and percentiles of
+  // the recorded values, as well as the non-empty buckets.
+  ERL_NIF_TERM ToTerm(ErlNifEnv* env) const;
+
+ private:
+  static int BucketIndex(uint64_t value);
+  static uint64_t BucketUpperBound(int index);
+
+  std::atomic<uint64_t> counts_[kBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+// The phases we measure on clients and devices.
+enum class MetricPhase {
+  kCompile,
+  kUnpackRunArguments,
+  kPopulateInputBuffers,
+  kRunAsync,
+  kBlockHostUntilDone,
+  kDecomposeBufferToTerm,
+  kToBinary,
+  kNumPhases
+};
+
+// A set of latency histograms, one per phase.
+class ExlaMetrics {
+ public:
+  LatencyHistogram* histogram(MetricPhase phase) {
+    return &histograms_[static_cast<int>(phase)];
+  }
+
+  // Returns a map from phase name to histogram, skipping
+  // the phases without recorded values.
+  ERL_NIF_TERM ToTerm(ErlNifEnv* env) const;
+
+ private:
+  LatencyHistogram histograms_[static_cast<int>(MetricPhase::kNumPhases)];
+};
+
+// Records the lifetime of the scope into the given phase.
+class ScopedLatency {
+ public:
+  ScopedLatency(ExlaMetrics* metrics, MetricPhase phase)
+    : histogram_(metrics->histogram(phase)),
+      start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedLatency() {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    histogram_->Record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+ private:
+  LatencyHistogram* histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace exla
+
+#endif
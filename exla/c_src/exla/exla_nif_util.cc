@@ -202,6 +202,23 @@ namespace nif {
     return 1;
   }
 
+  int get_list(ErlNifEnv* env,
+               ERL_NIF_TERM list,
+               std::vector<std::string> &var) {
+    unsigned int length;
+    if (!enif_get_list_length(env, list, &length)) return 0;
+    var.reserve(length);
+    ERL_NIF_TERM head, tail;
+
+    while (enif_get_list_cell(env, list, &head, &tail)) {
+      std::string elem;
+      if (!get(env, head, elem)) return 0;
+      var.push_back(elem);
+      list = tail;
+    }
+    return 1;
+  }
+
   int get_list(ErlNifEnv* env, ERL_NIF_TERM list, std::vector<int64> &var) {
     unsigned int length;
     if (!enif_get_list_length(env, list, &length)) return 0;
@@ -232,6 +249,17 @@ namespace nif {
     return term;
   }
 
+  ERL_NIF_TERM make_map(ErlNifEnv* env, std::map<std::string, double>& map) {
+    ERL_NIF_TERM term = enif_make_new_map(env);
+    std::map<std::string, double>::iterator itr;
+    for (itr = map.begin(); itr != map.end(); ++itr) {
+      ERL_NIF_TERM key = make(env, itr->first);
+      ERL_NIF_TERM value = enif_make_double(env, itr->second);
+      enif_make_map_put(env, term, key, value, &term);
+    }
+    return term;
+  }
+
   // Protobuf types
 
   int get_padding_config(ErlNifEnv* env,
@@ -386,6 +414,125 @@ namespace nif {
     return 1;
   }
 
+  int get_gather_dimension_numbers(ErlNifEnv* env,
+                                   ERL_NIF_TERM tuple,
+                                   xla::GatherDimensionNumbers* dimension_numbers) {
+    const ERL_NIF_TERM* terms;
+    int count;
+
+    if (!enif_get_tuple(env, tuple, &count, &terms)) return 0;
+    if (count != 4) return 0;
+
+    std::vector<int64> offset_dims;
+    std::vector<int64> collapsed_slice_dims;
+    std::vector<int64> start_index_map;
+    int64 index_vector_dim;
+
+    if (!get_list(env, terms[0], offset_dims)) return 0;
+    if (!get_list(env, terms[1], collapsed_slice_dims)) return 0;
+    if (!get_list(env, terms[2], start_index_map)) return 0;
+    if (!get(env, terms[3], &index_vector_dim)) return 0;
+
+    for (int64 dim : offset_dims) {
+      dimension_numbers->add_offset_dims(dim);
+    }
+    for (int64 dim : collapsed_slice_dims) {
+      dimension_numbers->add_collapsed_slice_dims(dim);
+    }
+    for (int64 dim : start_index_map) {
+      dimension_numbers->add_start_index_map(dim);
+    }
+    dimension_numbers->set_index_vector_dim(index_vector_dim);
+
+    return 1;
+  }
+
+  int get_scatter_dimension_numbers(ErlNifEnv* env,
+                                    ERL_NIF_TERM tuple,
+                                    xla::ScatterDimensionNumbers* dimension_numbers) {
+    const ERL_NIF_TERM* terms;
+    int count;
+
+    if (!enif_get_tuple(env, tuple, &count, &terms)) return 0;
+    if (count != 4) return 0;
+
+    std::vector<int64> update_window_dims;
+    std::vector<int64> inserted_window_dims;
+    std::vector<int64> scatter_dims_to_operand_dims;
+    int64 index_vector_dim;
+
+    if (!get_list(env, terms[0], update_window_dims)) return 0;
+    if (!get_list(env, terms[1], inserted_window_dims)) return 0;
+    if (!get_list(env, terms[2], scatter_dims_to_operand_dims)) return 0;
+    if (!get(env, terms[3], &index_vector_dim)) return 0;
+
+    for (int64 dim : update_window_dims) {
+      dimension_numbers->add_update_window_dims(dim);
+    }
+    for (int64 dim : inserted_window_dims) {
+      dimension_numbers->add_inserted_window_dims(dim);
+    }
+    for (int64 dim : scatter_dims_to_operand_dims) {
+      dimension_numbers->add_scatter_dims_to_operand_dims(dim);
+    }
+    dimension_numbers->set_index_vector_dim(index_vector_dim);
+
+    return 1;
+  }
+
+  int get_replica_groups(ErlNifEnv* env,
+                         ERL_NIF_TERM list,
+                         std::vector<xla::ReplicaGroup>& replica_groups) {
+    unsigned int length;
+    if (!enif_get_list_length(env, list, &length)) return 0;
+
+    replica_groups.reserve(length);
+    ERL_NIF_TERM head, tail;
+
+    while (enif_get_list_cell(env, list, &head, &tail)) {
+      std::vector<int64> replica_ids;
+      if (!get_list(env, head, replica_ids)) return 0;
+
+      xla::ReplicaGroup group;
+      for (int64 id : replica_ids) {
+        group.add_replica_ids(id);
+      }
+      replica_groups.push_back(group);
+
+      list = tail;
+    }
+
+    return 1;
+  }
+
+  int get_source_target_pairs(ErlNifEnv* env,
+                              ERL_NIF_TERM list,
+                              std::vector<std::pair<int64, int64>>& pairs) {
+    unsigned int length;
+    if (!enif_get_list_length(env, list, &length)) return 0;
+
+    pairs.reserve(length);
+    ERL_NIF_TERM head, tail;
+
+    while (enif_get_list_cell(env, list, &head, &tail)) {
+      const ERL_NIF_TERM* terms;
+      int count;
+
+      if (!enif_get_tuple(env, head, &count, &terms)) return 0;
+      if (count != 2) return 0;
+
+      int64 source, target;
+      if (!get(env, terms[0], &source)) return 0;
+      if (!get(env, terms[1], &target)) return 0;
+
+      pairs.push_back(std::pair<int64, int64>(source, target));
+
+      list = tail;
+    }
+
+    return 1;
+  }
+
   int get_general_padding(ErlNifEnv* env,
                           ERL_NIF_TERM padding_term,
                           std::vector<std::pair<int64, int64>>& padding) {
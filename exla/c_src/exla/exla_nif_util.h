@@ -115,7 +115,7 @@ ERL_NIF_TERM make(ErlNifEnv* env, const char* string);
 // their signatures are the same for retrieving/returning
 // regular strings.
 
-int get_atom(ErlNifEnv* env, ERL_NIF_TERM term, std::string* var);
+int get_atom(ErlNifEnv* env, ERL_NIF_TERM term, std::string &var);
 
 ERL_NIF_TERM atom(ErlNifEnv* env, const char* status);
 
@@ -222,6 +222,9 @@ int get_list(ErlNifEnv* env,
 int get_list(ErlNifEnv* env,
              ERL_NIF_TERM list,
              std::vector<ErlNifBinary> &var);
+int get_list(ErlNifEnv* env,
+             ERL_NIF_TERM list,
+             std::vector<std::string> &var);
 
 template <typename T>
 int get_list(ErlNifEnv* env, ERL_NIF_TERM list, std::vector<T*> &var) {
@@ -258,6 +261,7 @@ int get_list(ErlNifEnv* env, ERL_NIF_TERM list, std::vector<T> &var) {
 int get_binary(ErlNifEnv* env, ERL_NIF_TERM term, ErlNifBinary* var);
 
 ERL_NIF_TERM make_map(ErlNifEnv* env, std::map<std::string, int>& map);
+ERL_NIF_TERM make_map(ErlNifEnv* env, std::map<std::string, double>& map);
 
 // XLA Protobuf Types
 //
@@ -298,6 +302,33 @@ int get_conv_dimension_numbers(ErlNifEnv* env,
                                ERL_NIF_TERM tuple,
                                xla::ConvolutionDimensionNumbers* dimension_numbers);
 
+// Gets the gather dimension numbers. We receive them as a 4-tuple of
+// offset dims, collapsed slice dims, start index map (all lists) and
+// the index vector dimension.
+int get_gather_dimension_numbers(ErlNifEnv* env,
+                                 ERL_NIF_TERM tuple,
+                                 xla::GatherDimensionNumbers* dimension_numbers);
+
+// Gets the scatter dimension numbers. We receive them as a 4-tuple of
+// update window dims, inserted window dims, scatter dims to operand
+// dims (all lists) and the index vector dimension.
+int get_scatter_dimension_numbers(ErlNifEnv* env,
+                                  ERL_NIF_TERM tuple,
+                                  xla::ScatterDimensionNumbers* dimension_numbers);
+
+// Gets replica groups for collective operations. Replica groups are
+// given as a list of lists of replica ids. An empty list means all
+// replicas form a single group.
+int get_replica_groups(ErlNifEnv* env,
+                       ERL_NIF_TERM list,
+                       std::vector<xla::ReplicaGroup>& replica_groups);
+
+// Gets source-target pairs for CollectivePermute as a list of
+// 2-tuples of replica ids.
+int get_source_target_pairs(ErlNifEnv* env,
+                            ERL_NIF_TERM list,
+                            std::vector<std::pair<int64, int64>>& pairs);
+
 // Gets a general padding configuration. This is slightly different from
 // get_padding_config for usage in a convolution. The convolution only
 // supports passing padding as a vector of pairs of edge high, edge low padding
@@ -0,0 +1,143 @@
+#include "tensorflow/compiler/xla/exla/exla_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace exla {
+
+TraceRecorder* TraceRecorder::Get() {
+  static TraceRecorder* recorder = new TraceRecorder();
+  return recorder;
+}
+
+TraceRecorder::TraceRecorder() : enabled_(false),
+                                 next_(0),
+                                 epoch_(std::chrono::steady_clock::now()) {}
+
+void TraceRecorder::Start() {
+  enabled_.store(false, std::memory_order_relaxed);
+
+  // The buffer is allocated on first use and never freed, as
+  // scopes which started while recording may still write to it.
+  if (events_ == nullptr) {
+    events_.reset(new TraceEvent[kCapacity]);
+  }
+
+  for (uint64_t i = 0; i < kCapacity; i++) {
+    events_[i].sequence.store(0, std::memory_order_relaxed);
+  }
+
+  next_.store(0, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::Stop() {
+  enabled_.store(false, std::memory_order_release);
+}
+
+void TraceRecorder::Record(const char* name,
+                           const char* stream,
+                           const std::string& detail,
+                           int device_ordinal,
+                           uint64_t start_ns,
+                           uint64_t end_ns) {
+  uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+  TraceEvent& event = events_[index % kCapacity];
+
+  // A zero sequence marks the slot as being written, readers
+  // skip it until it is published with its index below. The
+  // fence keeps the writes below from moving before the mark.
+  event.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  event.name = name;
+  event.stream = stream;
+  size_t detail_size = std::min(detail.size(), size_t(TraceEvent::kDetailSize - 1));
+  std::memcpy(event.detail, detail.data(), detail_size);
+  event.detail[detail_size] = '\0';
+  event.thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+  event.device_ordinal = device_ordinal;
+  event.start_ns = start_ns;
+  event.duration_ns = end_ns - start_ns;
+
+  event.sequence.store(index + 1, std::memory_order_release);
+}
+
+static void AppendEscaped(std::string* out, const char* str) {
+  for (const char* c = str; *c != '\0'; c++) {
+    switch (*c) {
+      case '"': out->append("\\\""); break;
+      case '\\': out->append("\\\\"); break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", *c);
+          out->append(buf);
+        } else {
+          out->push_back(*c);
+        }
+    }
+  }
+}
+
+std::string TraceRecorder::ToChromeTrace() {
+  if (events_ == nullptr) {
+    return "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}";
+  }
+
+  uint64_t end = next_.load(std::memory_order_acquire);
+  uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  char buf[128];
+
+  for (uint64_t index = begin; index < end; index++) {
+    TraceEvent& slot = events_[index % kCapacity];
+
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index + 1) continue;
+
+    TraceEvent event;
+    event.name = slot.name;
+    event.stream = slot.stream;
+    std::memcpy(event.detail, slot.detail, TraceEvent::kDetailSize);
+    event.detail[TraceEvent::kDetailSize - 1] = '\0';
+    event.thread_id = slot.thread_id;
+    event.device_ordinal = slot.device_ordinal;
+    event.start_ns = slot.start_ns;
+    event.duration_ns = slot.duration_ns;
+
+    // The slot was overwritten while we copied it. The fence keeps
+    // the copies above from moving after the check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+    if (!first) out.push_back(',');
+    first = false;
+
+    out.append("{\"cat\":\"exla\",\"ph\":\"X\",\"pid\":0,\"name\":\"");
+    AppendEscaped(&out, event.name);
+
+    std::snprintf(buf, sizeof(buf),
+                  "\",\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"device\":%d,\"stream\":\"",
+                  static_cast<unsigned long long>(event.thread_id % 1000000007),
+                  event.start_ns / 1000.0,
+                  event.duration_ns / 1000.0,
+                  event.device_ordinal);
+    out.append(buf);
+    AppendEscaped(&out, event.stream);
+    out.append("\",\"detail\":\"");
+    AppendEscaped(&out, event.detail);
+    out.append("\"}}");
+  }
+
+  out.append("]}");
+  return out;
+}
+
+}  // namespace exla
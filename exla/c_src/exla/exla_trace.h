@@ -0,0 +1,114 @@
+#ifndef EXLA_TRACE_H_
+#define EXLA_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace exla {
+
+// A single traced event, spanning from `start_ns` to
+// `start_ns + duration_ns`. Names and streams are static
+// strings, the detail (such as an executable name) is copied
+// and truncated to fit the slot.
+struct TraceEvent {
+  static constexpr int kDetailSize = 64;
+
+  std::atomic<uint64_t> sequence;
+  const char* name;
+  const char* stream;
+  char detail[kDetailSize];
+  uint64_t thread_id;
+  int device_ordinal;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+};
+
+// Records native events into a fixed-size ring buffer which can
+// be dumped in the Chrome trace event format, readable by
+// chrome://tracing and Perfetto. Recording is disabled by default
+// and costs a single atomic load per event when disabled.
+//
+// Writers claim slots with an atomic counter and publish them with
+// a per-slot sequence number, so recording never takes a lock. Once
+// the buffer is full, the oldest events are overwritten.
+class TraceRecorder {
+ public:
+  static constexpr uint64_t kCapacity = 1 << 16;
+
+  static TraceRecorder* Get();
+
+  bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  // Clears the buffer and starts recording.
+  void Start();
+
+  // Stops recording. Recorded events are kept until the next start.
+  void Stop();
+
+  void Record(const char* name,
+              const char* stream,
+              const std::string& detail,
+              int device_ordinal,
+              uint64_t start_ns,
+              uint64_t end_ns);
+
+  // Returns the recorded events as Chrome trace JSON.
+  std::string ToChromeTrace();
+
+  // Nanoseconds since the recorder was created.
+  uint64_t Now() const {
+    auto elapsed = std::chrono::steady_clock::now() - epoch_;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  }
+
+ private:
+  TraceRecorder();
+
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> next_;
+  std::unique_ptr<TraceEvent[]> events_;
+  std::chrono::steady_clock::time_point epoch_;
+};
+
+// Records the lifetime of the scope as a trace event.
+// Does nothing if tracing is disabled when the scope starts.
+class ScopedTrace {
+ public:
+  ScopedTrace(const char* name,
+              const char* stream,
+              int device_ordinal,
+              const std::string& detail = "")
+    : recorder_(TraceRecorder::Get()) {
+    if (recorder_->enabled()) {
+      name_ = name;
+      stream_ = stream;
+      device_ordinal_ = device_ordinal;
+      detail_ = detail;
+      start_ns_ = recorder_->Now();
+    } else {
+      recorder_ = nullptr;
+    }
+  }
+
+  ~ScopedTrace() {
+    if (recorder_ != nullptr) {
+      recorder_->Record(name_, stream_, detail_, device_ordinal_,
+                        start_ns_, recorder_->Now());
+    }
+  }
+
+ private:
+  TraceRecorder* recorder_;
+  const char* name_;
+  const char* stream_;
+  int device_ordinal_;
+  std::string detail_;
+  uint64_t start_ns_;
+};
+
+}  // namespace exla
+
+#endif
@@ -39,6 +39,13 @@ defmodule EXLA do
         useful if multiple computations are done in a row. See
         "Device allocation" section
 
+    * `:quantize_weights` - when true, dot products against floating
+      point constants (such as weights captured by the function) are
+      computed in 8-bit integers. Weights are quantized at compile time
+      with one scale per output channel and inputs are quantized per
+      tensor at runtime. This trades precision for speed and memory.
+      Defaults to `false`
+
   ## Clients
 
   The `EXLA` library uses a client for compiling and executing code.
@@ -71,6 +78,20 @@ defmodule EXLA do
   such as memory. Therefore, we recommend developers to use the
   `:default` client as much as possible.
 
+  ## Logging
+
+  Logs emitted by XLA are forwarded to Elixir's `Logger` under
+  the `:xla` domain. They are filtered and rate limited natively,
+  before reaching the VM, which can be configured with:
+
+      config :exla, :logger,
+        level: :warning,
+        max_per_second: 100
+
+  `:level` is one of `:info` (the default), `:warning` or `:error`.
+  `:max_per_second` defaults to 1000. Messages beyond this limit
+  are dropped and reported in a single warning.
+
   ## Device allocation
 
   EXLA also ships with a `EXLA.DeviceBackend` that allows data
@@ -220,6 +241,18 @@ defmodule EXLA do
 
           target_features: "+sse4.1 +sse4.2 +avx +avx2 +fma"
 
+    * `:target_cpus` - a list of x86-64 microarchitecture levels to
+      build variants for. The compiled NIF detects the running CPU
+      when loaded and uses the best variant it supports, falling
+      back to a baseline compiled with `:target_features`:
+
+          target_cpus: ["x86-64-v2", "x86-64-v3", "x86-64-v4"]
+
+    * `:num_threads` - the size of the thread pool shared by the
+      compiled functions. Defaults to the number of logical cores
+      and may be overridden with the `EXLA_AOT_NUM_THREADS`
+      environment variable when the NIF is loaded
+
   The following options might be used for cross compilation:
 
     * `:bazel_flags` - flags that customize `bazel build` command
@@ -9,6 +9,21 @@ defmodule EXLA.AOT do
   require Logger
   @tf_rev "6af836f407f546cf2f9ab3b5fcb7a8285bda5c96"
 
+  # The x86-64 microarchitecture levels we know how to detect at
+  # runtime, with the LLVM features each one enables. The level
+  # number is what the generated NIF compares against cpuid.
+  @x86_64_levels %{
+    "x86-64" => {1, ""},
+    "x86-64-v2" => {2, "+cx16,+popcnt,+sse3,+sse4.1,+sse4.2,+ssse3"},
+    "x86-64-v3" =>
+      {3,
+       "+cx16,+popcnt,+sse3,+sse4.1,+sse4.2,+ssse3,+avx,+avx2,+bmi,+bmi2,+f16c,+fma,+lzcnt,+movbe"},
+    "x86-64-v4" =>
+      {4,
+       "+cx16,+popcnt,+sse3,+sse4.1,+sse4.2,+ssse3,+avx,+avx2,+bmi,+bmi2,+f16c,+fma,+lzcnt,+movbe," <>
+         "+avx512f,+avx512bw,+avx512cd,+avx512dq,+avx512vl"}
+  }
+
   @doc """
   Compiles a shared object file at the given `output_dir`
   for `module_name` with the given `functions`.
@@ -56,6 +71,19 @@ defmodule EXLA.AOT do
       It must be a list of tuples where the env key and env value
       are binaries
 
+    * `:target_cpus` - a list of x86-64 microarchitecture levels
+      to build variants for, such as `["x86-64-v2", "x86-64-v3", "x86-64-v4"]`.
+      Every function is compiled once per level and the NIF picks
+      the best variant supported by the running CPU when it is
+      loaded. A baseline `"x86-64"` variant, compiled with the
+      given `:target_features`, is always included as a fallback
+
+    * `:num_threads` - the size of the thread pool shared by all
+      functions in the NIF. Defaults to the number of logical
+      cores of the host when the NIF is loaded. It can also
+      be overridden at load time with the `EXLA_AOT_NUM_THREADS`
+      environment variable
+
   Also see the options in `EXLA.Compilation.compile_aot/7`.
   """
   def compile(output_dir, module_name, functions, options \\ [])
@@ -76,8 +104,9 @@ defmodule EXLA.AOT do
       lib_name: lib_name,
       module_name: module_name,
       runtimes: options[:runtimes] || [],
-      target_features: options[:target_features],
       target_triple: target_triple,
+      variants: variants(options[:target_cpus], options[:target_features], target_triple),
+      num_threads: options[:num_threads] || 0,
       target_path: target_path,
       tf_path: tf_path
     }
@@ -147,24 +176,60 @@ defmodule EXLA.AOT do
 
     {:ok, pbtext_path} = write_graph_config_file(name, arity, args, sizes, config)
 
-    header_path = Path.join(config.aot_path, "#{name}_#{arity}.h")
-    object_path = Path.join(config.aot_path, "#{name}_#{arity}.o")
-
-    :ok =
-      Computation.compile_aot(
-        comp,
-        pbtext_path,
-        header_path,
-        object_path,
-        "#{name}_#{arity}",
-        "#{name}_#{arity}_class",
-        target_triple: config.target_triple,
-        target_features: config.target_features
-      )
+    for variant <- config.variants do
+      function_name = Codegen.variant_name(name, arity, variant)
+      header_path = Path.join(config.aot_path, "#{function_name}.h")
+      object_path = Path.join(config.aot_path, "#{function_name}.o")
+
+      :ok =
+        Computation.compile_aot(
+          comp,
+          pbtext_path,
+          header_path,
+          object_path,
+          function_name,
+          "#{function_name}_class",
+          target_triple: config.target_triple,
+          target_cpu: variant.cpu,
+          target_features: variant.features
+        )
+    end
 
     {name, arity, args, sizes}
   end
 
+  # Without target CPUs, we compile a single variant exactly as given.
+  # Otherwise we compile one variant per level, highest level first,
+  # plus the baseline which is used when no other level is supported.
+  defp variants(nil, features, _target_triple) do
+    [%{level: nil, cpu: "", features: features || ""}]
+  end
+
+  defp variants(cpus, features, target_triple) when is_list(cpus) do
+    unless String.starts_with?(target_triple, "x86_64") do
+      raise ArgumentError,
+            ":target_cpus is only supported for x86_64 targets, got: #{inspect(target_triple)}"
+    end
+
+    levels =
+      for cpu <- cpus, uniq: true do
+        case @x86_64_levels do
+          %{^cpu => {level, level_features}} ->
+            %{level: level, cpu: cpu, features: level_features}
+
+          %{} ->
+            raise ArgumentError,
+                  "unknown target CPU #{inspect(cpu)}, expected one of: " <>
+                    inspect(Enum.sort(Map.keys(@x86_64_levels)))
+        end
+      end
+
+    baseline = %{level: 1, cpu: "", features: features || ""}
+
+    [baseline | Enum.reject(levels, &(&1.level == 1))]
+    |> Enum.sort_by(& &1.level, :desc)
+  end
+
   defp write_graph_config_file(name, arity, args, sizes, config) do
     pbtext = Codegen.generate_graph_config_file(args, sizes)
     pbtext_path = Path.join(config.aot_path, "#{name}_#{arity}.pbtxt")
@@ -174,7 +239,13 @@ defmodule EXLA.AOT do
 
   defp write_nif_source_file(functions, config) do
     src =
-      Codegen.generate_nif_source_file(functions, config.module_name, config.aot_relative_path)
+      Codegen.generate_nif_source_file(
+        functions,
+        config.variants,
+        config.num_threads,
+        config.module_name,
+        config.aot_relative_path
+      )
 
     nif_path = Path.join(config.aot_path, config.lib_name <> ".cc")
     File.write!(nif_path, src)
@@ -182,7 +253,14 @@ defmodule EXLA.AOT do
   end
 
   defp write_bazel_build_file(functions, config) do
-    build = Codegen.generate_bazel_build_file(functions, config.runtimes, config.lib_name)
+    build =
+      Codegen.generate_bazel_build_file(
+        functions,
+        config.variants,
+        config.runtimes,
+        config.lib_name
+      )
+
     build_path = Path.join(config.aot_path, "BUILD")
     File.write!(build_path, build)
     :ok
@@ -66,11 +66,18 @@ defmodule EXLA.AOT.Codegen do
     result_ids |> Enum.join("\n")
   end
 
+  ## Variants
+
+  # A variant without a level is the only one compiled,
+  # so it keeps the plain function name.
+  def variant_name(name, arity, %{level: nil}), do: "#{name}_#{arity}"
+  def variant_name(name, arity, %{level: level}), do: "#{name}_#{arity}_v#{level}"
+
   ## Generating the BUILD file
 
-  def generate_bazel_build_file(functions, runtimes, lib_name) do
+  def generate_bazel_build_file(functions, variants, runtimes, lib_name) do
     name = build_bazel_so_str(lib_name)
-    srcs = build_bazel_srcs_str(functions, lib_name)
+    srcs = build_bazel_srcs_str(functions, variants, lib_name)
     deps = build_bazel_deps_str(runtimes)
     linkopts = build_bazel_linkopts_str()
 
@@ -95,14 +102,14 @@ defmodule EXLA.AOT.Codegen do
     "[" <> deps_str <> "]"
   end
 
-  defp build_bazel_srcs_str(functions, lib_name) do
+  defp build_bazel_srcs_str(functions, variants, lib_name) do
     cc_name = str(lib_name <> ".cc")
 
     src_files =
-      functions
-      |> Enum.flat_map(fn {name, arity, _, _} ->
-        [str(Atom.to_string(name) <> "_#{arity}.h"), str(Atom.to_string(name) <> "_#{arity}.o")]
-      end)
+      for {name, arity, _, _} <- functions, variant <- variants do
+        variant_name = variant_name(name, arity, variant)
+        str(variant_name <> ".h") <> ", " <> str(variant_name <> ".o")
+      end
       |> Enum.join(", ")
 
     "[" <> cc_name <> ", " <> src_files <> "]" <> "+" <> @bazel_erts_glob
@@ -114,12 +121,12 @@ defmodule EXLA.AOT.Codegen do
 
   ## Generating the NIF Source File
 
-  def generate_nif_source_file(functions, target_module, aot_relative_path) do
+  def generate_nif_source_file(functions, variants, num_threads, target_module, aot_relative_path) do
     define_block_str = build_define_block()
-    include_block_str = build_include_block(functions, aot_relative_path)
+    include_block_str = build_include_block(functions, variants, aot_relative_path)
     error_block_str = build_error_helper_block()
-    load_block_str = build_load_block()
-    functions_str = build_nif_funcs(functions)
+    load_block_str = build_runtime_block() <> build_load_block(variants, num_threads)
+    functions_str = build_nif_funcs(functions, variants)
     nif_func_export_array_str = build_nif_func_export_array(functions)
     init_block_str = build_init_block(target_module)
 
@@ -136,16 +143,26 @@ defmodule EXLA.AOT.Codegen do
     """
   end
 
-  defp build_include_block(functions, aot_relative_path) do
+  defp build_include_block(functions, variants, aot_relative_path) do
     function_includes =
-      functions
-      |> Enum.map(fn {name, arity, _, _} ->
-        build_include_str(Atom.to_string(name) <> "_#{arity}")
-      end)
+      for {name, arity, _, _} <- functions, variant <- variants do
+        build_include_str(variant_name(name, arity, variant))
+      end
       |> Enum.join("\n")
 
     erl_nif_path = Path.join(aot_relative_path, "erts/erl_nif")
-    function_includes <> "\n" <> build_include_str(erl_nif_path) <> "\n"
+
+    function_includes <>
+      "\n" <>
+      build_include_str(erl_nif_path) <>
+      "\n" <>
+      """
+      #include <cstdlib>
+      #include <memory>
+      #include <mutex>
+      #include <thread>
+      #include <vector>
+      """
   end
 
   defp build_include_str(path) do
@@ -160,20 +177,214 @@ defmodule EXLA.AOT.Codegen do
     """
   end
 
-  defp build_load_block do
+  # The thread pool is created once on load and shared by all functions.
+  # Each function keeps a pool of instances, so the result and temp
+  # buffers are allocated once and reused across calls. Concurrent
+  # calls borrow distinct instances, so the pool grows up to the
+  # number of simultaneous callers.
+  defp build_runtime_block do
+    """
+    static Eigen::ThreadPool* thread_pool = nullptr;
+    static Eigen::ThreadPoolDevice* device = nullptr;
+
+    // Pools register themselves, so unload can free their instances,
+    // which point to the device, before the device is freed.
+    class InstancePoolBase {
+     public:
+      virtual void Clear() = 0;
+    };
+
+    static std::mutex pools_mutex;
+    static std::vector<InstancePoolBase*> pools;
+
+    template <typename T>
+    class InstancePool : public InstancePoolBase {
+     public:
+      struct Releaser {
+        InstancePool* pool;
+        void operator()(T* instance) const { pool->Release(instance); }
+      };
+
+      using Lease = std::unique_ptr<T, Releaser>;
+
+      InstancePool() {
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        pools.push_back(this);
+      }
+
+      ~InstancePool() { Clear(); }
+
+      void Clear() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (T* instance : free_) delete instance;
+        free_.clear();
+      }
+
+      Lease Borrow() {
+        T* instance = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!free_.empty()) {
+            instance = free_.back();
+            free_.pop_back();
+          }
+        }
+
+        if (instance == nullptr) {
+          instance = new T(T::AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY);
+          instance->set_thread_pool(device);
+        }
+
+        return Lease(instance, Releaser{this});
+      }
+
+     private:
+      void Release(T* instance) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(instance);
+      }
+
+      std::mutex mutex_;
+      std::vector<T*> free_;
+    };
+
+    static int num_threads(int compiled) {
+      char value[16];
+      size_t size = sizeof(value);
+      if (enif_getenv("EXLA_AOT_NUM_THREADS", value, &size) == 0) {
+        int parsed = std::atoi(value);
+        if (parsed > 0) return parsed;
+      }
+      if (compiled > 0) return compiled;
+      unsigned hardware = std::thread::hardware_concurrency();
+      return hardware > 0 ? hardware : 1;
+    }
+
+    static void start_thread_pool(int compiled) {
+      thread_pool = new Eigen::ThreadPool(num_threads(compiled));
+      device = new Eigen::ThreadPoolDevice(thread_pool, thread_pool->NumThreads());
+    }
+
+    static void unload(ErlNifEnv* env, void* priv) {
+      {
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        for (InstancePoolBase* pool : pools) pool->Clear();
+        pools.clear();
+      }
+
+      delete device;
+      delete thread_pool;
+      device = nullptr;
+      thread_pool = nullptr;
+    }
+    """
+  end
+
+  defp build_load_block([_single], num_threads) do
+    """
+    static int load(ErlNifEnv* env, void **priv, ERL_NIF_TERM load_info) {
+      start_thread_pool(#{num_threads});
+      return 0;
+    }
+    """
+  end
+
+  defp build_load_block(variants, num_threads) do
+    levels = Enum.map_join(variants, ", ", & &1.level)
+
+    build_cpu_level_block() <>
+      """
+      // Levels of the compiled variants, from the highest to the baseline.
+      static const int variant_levels[] = {#{levels}};
+      static int variant = #{length(variants) - 1};
+
+      static int load(ErlNifEnv* env, void **priv, ERL_NIF_TERM load_info) {
+        int level = cpu_level();
+        for (int i = 0; i < #{length(variants)}; i++) {
+          if (variant_levels[i] <= level) {
+            variant = i;
+            break;
+          }
+        }
+        start_thread_pool(#{num_threads});
+        return 0;
+      }
+      """
+  end
+
+  # Detects the x86-64 microarchitecture level of the running CPU.
+  # Besides the cpuid feature bits, AVX and AVX-512 also require the
+  # OS to save the extended register state, which we check via xgetbv.
+  defp build_cpu_level_block do
     """
-    static int load(ErlNifEnv* env, void **priv, ERL_NIF_TERM load_info) { return 0; }
+    #if defined(_MSC_VER)
+    #include <intrin.h>
+    static void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+      __cpuidex(reinterpret_cast<int*>(regs), leaf, subleaf);
+    }
+    static unsigned long long xgetbv() { return _xgetbv(0); }
+    #else
+    #include <cpuid.h>
+    static void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+      __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    }
+    static unsigned long long xgetbv() {
+      unsigned int lo, hi;
+      __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+      return (static_cast<unsigned long long>(hi) << 32) | lo;
+    }
+    #endif
+
+    static bool has_bits(unsigned long long reg, unsigned long long mask) { return (reg & mask) == mask; }
+
+    static int cpu_level() {
+      unsigned int regs[4];
+      cpuid(0, 0, regs);
+      unsigned int max_leaf = regs[0];
+      cpuid(0x80000000, 0, regs);
+      unsigned int max_ext_leaf = regs[0];
+      if (max_leaf < 1) return 1;
+
+      cpuid(1, 0, regs);
+      unsigned int ecx1 = regs[2];
+      unsigned int ebx7 = 0;
+      unsigned int ecx81 = 0;
+      if (max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        ebx7 = regs[1];
+      }
+      if (max_ext_leaf >= 0x80000001) {
+        cpuid(0x80000001, 0, regs);
+        ecx81 = regs[2];
+      }
+
+      // ssse3, sse4.1, sse4.2, cx16, popcnt
+      if (!has_bits(ecx1, (1u << 9) | (1u << 19) | (1u << 20) | (1u << 13) | (1u << 23))) return 1;
+
+      // osxsave, avx and the OS saving xmm/ymm state
+      if (!has_bits(ecx1, (1u << 27) | (1u << 28)) || !has_bits(xgetbv(), 0x6)) return 2;
+
+      // fma, movbe, f16c, bmi1, avx2, bmi2, lzcnt
+      if (!has_bits(ecx1, (1u << 12) | (1u << 22) | (1u << 29)) ||
+          !has_bits(ebx7, (1u << 3) | (1u << 5) | (1u << 8)) ||
+          !has_bits(ecx81, 1u << 5)) return 2;
+
+      // avx512f, avx512dq, avx512cd, avx512bw, avx512vl and the OS saving zmm state
+      if (!has_bits(ebx7, (1u << 16) | (1u << 17) | (1u << 28) | (1u << 30) | (1u << 31)) ||
+          !has_bits(xgetbv(), 0xe6)) return 3;
+
+      return 4;
+    }
     """
   end
 
-  defp build_nif_funcs(functions) do
+  defp build_nif_funcs(functions, variants) do
     functions
-    |> Enum.map(&build_nif_func_block(&1))
+    |> Enum.map(&build_nif_func_block(&1, variants))
     |> Enum.join("\n")
   end
 
-  defp build_nif_func_block({name, arity, args, result_sizes}) do
-    class_name = "#{name}_#{arity}_class"
+  defp build_nif_func_block({name, arity, args, result_sizes}, variants) do
     signature_str = build_nif_func_signature(name, arity)
 
     args_str =
@@ -184,18 +395,41 @@ defmodule EXLA.AOT.Codegen do
 
     run_str = build_nif_run_block(name, arity)
     result_str = build_nif_results_block(name, arity, result_sizes)
+    dispatch_str = build_nif_dispatch_block(name, arity, variants)
 
     """
-    #{signature_str}{
-      unsigned num_threads = std::thread::hardware_concurrency();
-      Eigen::ThreadPool tp(num_threads);
-      Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
-      #{class_name} #{name}_#{arity}(#{class_name}::AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY);
-      #{name}_#{arity}.set_thread_pool(&device);
+    template <typename T>
+    static ERL_NIF_TERM #{name}_#{arity}_run(ErlNifEnv* env, const ERL_NIF_TERM argv[]) {
+      static InstancePool<T> pool;
+      auto #{name}_#{arity} = pool.Borrow();
       #{args_str}
       #{run_str}
       #{result_str}
     }
+
+    #{signature_str}{
+      #{dispatch_str}
+    }
+    """
+  end
+
+  defp build_nif_dispatch_block(name, arity, [variant]) do
+    "return #{name}_#{arity}_run<#{variant_name(name, arity, variant)}_class>(env, argv);"
+  end
+
+  defp build_nif_dispatch_block(name, arity, variants) do
+    cases =
+      variants
+      |> Enum.with_index()
+      |> Enum.map_join("\n", fn {variant, i} ->
+        "case #{i}: return #{name}_#{arity}_run<#{variant_name(name, arity, variant)}_class>(env, argv);"
+      end)
+
+    """
+    switch (variant) {
+      #{cases}
+      default: return error(env, "no compiled variant for this CPU");
+    }
     """
   end
 
@@ -213,13 +447,13 @@ defmodule EXLA.AOT.Codegen do
     if(!enif_inspect_binary(env, argv[#{i}], &arg#{i})) {
       return error(env, #{error_msg});
     }
-    #{name}_#{arity}.set_arg#{i}_data(arg#{i}.data);
+    #{name}_#{arity}->set_arg#{i}_data(arg#{i}.data);
     """
   end
 
   defp build_nif_run_block(name, arity) do
     """
-    #{name}_#{arity}.Run();
+    #{name}_#{arity}->Run();
     """
   end
 
@@ -253,7 +487,7 @@ defmodule EXLA.AOT.Codegen do
     if(!enif_alloc_binary(#{size}, &result#{i})) {
       return error(env, #{error_msg});
     }
-    unsigned char * result#{i}_bytes = reinterpret_cast<unsigned char *>(#{name}_#{arity}.result#{i}_data());
+    unsigned char * result#{i}_bytes = reinterpret_cast<unsigned char *>(#{name}_#{arity}->result#{i}_data());
     std::memcpy(
       result#{i}.data,
       result#{i}_bytes,
@@ -283,7 +517,7 @@ defmodule EXLA.AOT.Codegen do
 
   defp build_init_block(target_module) do
     """
-    ERL_NIF_INIT(#{target_module}, nif_funcs, &load, NULL, NULL, NULL);
+    ERL_NIF_INIT(#{target_module}, nif_funcs, &load, NULL, NULL, &unload);
     """
   end
 
@@ -91,6 +91,51 @@ defmodule EXLA.Client do
     end
   end
 
+  @doc """
+  Returns the latency metrics recorded natively by the client.
+
+  The result is a map with two keys:
+
+    * `:client` - the metrics for the client, such as `:compile`
+    * `:devices` - a map from device ordinal to the metrics of
+      runs and transfers on said device, such as `:run_async`,
+      `:block_host_until_done` and `:to_binary`
+
+  Each metric is a histogram with the `:count`, `:sum_ns`, `:max_ns`,
+  `:p50`, `:p90`, `:p99` and `:p999` of the recorded durations, in
+  nanoseconds, and the non-empty `:buckets` as `{upper_bound_ns, count}`
+  tuples. Phases without recorded durations are omitted.
+  """
+  def get_metrics(%Client{ref: ref}) do
+    EXLA.NIF.get_metrics(ref) |> unwrap!()
+  end
+
+  @doc """
+  Enqueues `data` with the given `shape` on the infeed queue of the
+  device at `device_ordinal`.
+
+  The value is consumed by the next `EXLA.Op.infeed/2` executed on
+  that device. A long-running executable, such as one built around a
+  while loop, can consume a stream of values with a single launch.
+  """
+  def transfer_to_infeed(%Client{ref: ref} = client, device_ordinal, data, %EXLA.Shape{} = shape)
+      when is_binary(data) do
+    ordinal = validate_device_ordinal!(client, device_ordinal)
+    EXLA.NIF.transfer_to_infeed(ref, ordinal, data, shape.ref) |> unwrap!()
+  end
+
+  @doc """
+  Blocks until an `EXLA.Op.outfeed/2` on the device at `device_ordinal`
+  produces a value of the given `shape` and returns it as a binary.
+
+  Outfeeds block the executable until they are read, so this is
+  usually called from a separate process while the executable runs.
+  """
+  def transfer_from_outfeed(%Client{ref: ref} = client, device_ordinal, %EXLA.Shape{} = shape) do
+    ordinal = validate_device_ordinal!(client, device_ordinal)
+    EXLA.NIF.transfer_from_outfeed(ref, ordinal, shape.ref) |> unwrap!()
+  end
+
   @doc """
   Returns a map of supported platforms with device information.
   """
@@ -98,6 +143,7 @@ defmodule EXLA.Client do
     EXLA.NIF.get_supported_platforms() |> unwrap!()
   end
 
+  defp unwrap!(:ok), do: :ok
   defp unwrap!({:ok, ref}), do: ref
   defp unwrap!({:error, error}), do: raise(List.to_string(error))
 end
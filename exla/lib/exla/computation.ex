@@ -15,6 +15,9 @@ defmodule EXLA.Computation do
 
     * `:num_replicas` - the number of replicas this computation will run on
     * `:use_spmd` - enable single-program multiple data
+    * `:hlo_passes` - a list of HLO passes to run on the computation
+      before compiling it. See `run_hlo_passes/2` for the supported
+      passes. The pass report is stored in the executable `:pass_report`
 
   Currently those options do not have an effect as they related to running the
   same compiled executabled on multiple replicas.
@@ -33,6 +36,12 @@ defmodule EXLA.Computation do
 
     output_shape = assert_output_shape!(computation)
 
+    {computation, pass_report} =
+      case Keyword.get(options, :hlo_passes, []) do
+        [] -> {computation, nil}
+        passes -> run_hlo_passes(computation, passes)
+      end
+
     # TODO: Validate replicas and partitions against the client
 
     ref =
@@ -51,10 +60,55 @@ defmodule EXLA.Computation do
       ref: ref,
       output_shape: output_shape,
       num_replicas: num_replicas,
-      num_partitions: num_partitions
+      num_partitions: num_partitions,
+      pass_report: pass_report
     }
   end
 
+  @doc """
+  Runs the given HLO passes, in order, over the computation.
+
+  Returns the optimized computation and a report with the number
+  of HLO instructions before and after running the passes, which
+  is useful to shrink computations before compiling or exporting
+  them. The supported passes are:
+
+    * `"algsimp"` - algebraic simplification
+    * `"constant_folding"` - evaluates instructions with constant operands
+    * `"cse"` - common subexpression elimination
+    * `"dce"` - dead code elimination
+    * `"tuple-simplifier"` - removes redundant tuple and get-tuple-element pairs
+    * `"reshape-mover"` - moves reshapes and transposes past elementwise ops
+    * `"simplify-while-loops"` - removes and simplifies while loops
+    * `"call-inliner"` - inlines calls
+    * `"flatten-call-graph"` - ensures every computation has a single caller
+
+  ## Examples
+
+      {computation, report} =
+        EXLA.Computation.run_hlo_passes(computation, ["algsimp", "cse", "dce"])
+
+      report.instructions_before
+      #=> 12
+
+      report.instructions_after
+      #=> 7
+
+  """
+  def run_hlo_passes(%Computation{ref: ref} = computation, passes) when is_list(passes) do
+    {ref, instructions_before, instructions_after, changed?} =
+      EXLA.NIF.run_hlo_passes(ref, passes) |> unwrap!()
+
+    report = %{
+      passes: passes,
+      instructions_before: instructions_before,
+      instructions_after: instructions_after,
+      changed: changed?
+    }
+
+    {%{computation | ref: ref}, report}
+  end
+
   @doc """
   Performs AOT compilation of the given computation.
 
@@ -79,6 +133,10 @@ defmodule EXLA.Computation do
 
           target_triple: "x86_64-pc-linux"
 
+    * `:target_cpu` - the CPU to tune the generated code for,
+      such as `"x86-64-v3"` or `"skylake-avx512"`. It defaults
+      to the generic CPU of the target triple
+
     * `:target_features` - the default executable makes
       no assumption about the target runtime, so special
       instructions such as SIMD are not leveraged. But you
@@ -106,6 +164,7 @@ defmodule EXLA.Computation do
       function_name,
       class_name,
       options[:target_triple] || target_triple(),
+      options[:target_cpu] || "",
       options[:target_features] || ""
     )
   end
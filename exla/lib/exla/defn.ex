@@ -39,6 +39,13 @@ defmodule EXLA.Defn do
     Tree.composite(expr, acc, &aot_runtimes/2)
   end
 
+  defp aot_runtimes(%T{data: %Expr{op: :while, args: args}} = expr, acc) do
+    [_, condition, body] = args
+    {_, acc} = aot_runtimes(condition, acc)
+    {_, acc} = aot_runtimes(body, acc)
+    aot_runtimes_args(expr, acc)
+  end
+
   defp aot_runtimes(%T{data: %Expr{op: op}} = expr, acc) do
     acc = if runtime = @aot_runtimes[op], do: Map.put(acc, runtime, true), else: acc
     aot_runtimes_args(expr, acc)
@@ -122,6 +129,7 @@ defmodule EXLA.Defn do
 
     state = %{
       precision: Keyword.get(options, :precision, :default),
+      quantize_weights: Keyword.get(options, :quantize_weights, false),
       builder: builder,
       params: params
     }
@@ -180,6 +188,32 @@ defmodule EXLA.Defn do
     end
   end
 
+  defp cached_recur_operator(:while, %T{data: %Expr{args: args}}, state, cache) do
+    [initial, condition, body] = args
+    {initial, cache} = to_computation_result(initial, state, cache)
+    condition = to_while_computation(:while_condition, condition, initial, state)
+    body = to_while_computation(:while_body, body, initial, state)
+    {EXLA.Op.while(condition, body, initial), cache}
+  end
+
+  defp cached_recur_operator(
+         :dot,
+         %T{type: {:f, _}, data: %Expr{args: [left, axes1, right, axes2]}} = t,
+         %{quantize_weights: true} = state,
+         cache
+       )
+       when axes2 != [] do
+    case right do
+      %T{data: %Expr{op: :tensor, args: [%T{type: {:f, _}} = weight]}} ->
+        {left, cache} = recur_operator(left, state, cache)
+        {to_quantized_dot(left, axes1, weight, axes2, t, state), cache}
+
+      %T{} ->
+        {args, cache} = Tree.traverse_args(t, cache, &recur_operator(&1, state, &2))
+        {to_operator(:dot, args, t, state), cache}
+    end
+  end
+
   defp cached_recur_operator(:parameter, %T{data: %Expr{args: [i]}}, state, cache) do
     {Enum.fetch!(state.params, i), cache}
   end
@@ -287,6 +321,50 @@ defmodule EXLA.Defn do
     EXLA.Op.dot_general(to_type(left, type), to_type(right, type), {axes1, axes2}, precision)
   end
 
+  # Weights are quantized on the host to s8 with one symmetric scale per
+  # output channel. Activations are quantized per tensor at runtime and
+  # the product is accumulated in s32 before being rescaled.
+  defp to_quantized_dot(left, axes1, weight, axes2, %{type: type, shape: shape}, state) do
+    builder = state.builder
+
+    w_scale =
+      weight
+      |> Nx.abs()
+      |> Nx.reduce_max(axes: axes2, keep_axes: true)
+      |> Nx.divide(127)
+      |> Nx.max(1.0e-12)
+
+    w_q =
+      weight
+      |> Nx.divide(w_scale)
+      |> Nx.round()
+      |> Nx.clip(-127, 127)
+      |> Nx.as_type({:s, 8})
+
+    w_scale = w_scale |> Nx.squeeze(axes: axes2) |> Nx.as_type(type)
+    w_dims = shape |> Nx.axes() |> Enum.take(-Nx.rank(w_scale)) |> List.to_tuple()
+    w_q = to_operator(:tensor, [w_q], w_q, state)
+    w_scale = to_operator(:tensor, [w_scale], w_scale, state)
+
+    x = to_type(left, type)
+    x_abs = EXLA.Op.abs(x)
+    x_max = to_operator(:reduce_max, [x_abs, [axes: nil]], %{type: type, shape: {}}, state)
+
+    x_scale =
+      x_max
+      |> EXLA.Op.divide(EXLA.Op.constant_r0(builder, 127, type))
+      |> EXLA.Op.max(EXLA.Op.constant_r0(builder, 1.0e-12, type))
+
+    zero_point = EXLA.Op.constant_r0(builder, 0, type)
+    x_q = EXLA.Lib.quantize(builder, x, x_scale, zero_point, nil)
+
+    x_q
+    |> EXLA.Op.dot_general(w_q, {axes1, axes2}, state.precision, {:s, 32})
+    |> EXLA.Op.convert_element_type(type)
+    |> EXLA.Op.multiply(x_scale)
+    |> EXLA.Op.multiply(w_scale, w_dims)
+  end
+
   defp to_operator(
          :conv,
          [operand, kernel, opts],
@@ -917,6 +995,35 @@ defmodule EXLA.Defn do
     {EXLA.Op.tuple(state.builder, args), comp}
   end
 
+  ## While
+
+  defp to_while_computation(name, %T{data: %Expr{op: :fun, args: args}}, initial, state) do
+    [[arg], expr, _fun] = args
+    subbuilder = subbuilder(state.builder, Atom.to_string(name))
+    param = EXLA.Op.parameter(subbuilder, 0, EXLA.Op.get_shape(initial), "p")
+    params = while_params(arg, param)
+
+    result =
+      expr
+      |> to_computation_result(%{state | builder: subbuilder, params: params}, %{})
+      |> elem(0)
+
+    result = if name == :while_condition, do: to_type(result, {:pred, 8}), else: result
+    EXLA.Builder.build(result)
+  end
+
+  # The loop state is a (possibly nested) tuple, while the
+  # function parameters are numbered in depth-first order.
+  defp while_params(tuple, param) when is_tuple(tuple) do
+    # TODO: Use Enum.with_index on Elixir v1.12
+    tuple
+    |> Tuple.to_list()
+    |> Enum.with_index()
+    |> Enum.flat_map(fn {arg, i} -> while_params(arg, EXLA.Op.get_tuple_element(param, i)) end)
+  end
+
+  defp while_params(_tensor, param), do: [param]
+
   ## Axes helpers
 
   defp broadcast_axes(left, right) do
@@ -7,7 +7,7 @@ defmodule EXLA.Executable do
   alias EXLA.{Buffer, Shape, Client}
 
   @enforce_keys [:client, :ref, :output_shape, :num_replicas, :num_partitions]
-  defstruct [:client, :ref, :output_shape, :num_replicas, :num_partitions, :async]
+  defstruct [:client, :ref, :output_shape, :num_replicas, :num_partitions, :async, :pass_report]
 
   @doc """
   Runs the given executable with arguments.
@@ -33,15 +33,55 @@ defmodule EXLA.Executable do
   """
   def run(%Executable{} = executable, arguments, options \\ []) do
     %{client: client, output_shape: output_shape} = executable
-    {data, _} = run(client, executable, arguments, options, 0)
+    {data, _} = run(client, executable, arguments, options, 0, 0)
     decompose_output(data, output_shape, client)
   end
 
+  @doc """
+  Runs the given executable with arguments and collects its
+  execution profile.
+
+  Returns a tuple with the output and a map with the `:compute_time_ns`,
+  `:compute_cycle_count` and `:compute_and_transfer_time_ns` of the run.
+  Accepts the same options as `run/3`.
+  """
+  def run_with_profile(%Executable{} = executable, arguments, options \\ []) do
+    %{client: client, output_shape: output_shape} = executable
+    {data, _, profile} = run(client, executable, arguments, options, 0, 1)
+    {decompose_output(data, output_shape, client), atomize_keys(profile)}
+  end
+
+  @doc """
+  Returns XLA's cost analysis of the executable.
+
+  The result is a map with estimates of the `:flops`,
+  `:transcendentals` and `:bytes_accessed` by the executable,
+  as well as the `:optimal_seconds` it would take to run. Those
+  are the inputs for a roofline analysis of the computation.
+
+  ## Options
+
+    * `:partition` - the partition to analyze (defaults to `1`)
+
+  """
+  def cost_analysis(%Executable{ref: ref}, options \\ []) do
+    partition = Keyword.get(options, :partition, 1)
+
+    ref
+    |> EXLA.NIF.get_cost_analysis(partition)
+    |> unwrap!()
+    |> atomize_keys()
+  end
+
+  defp atomize_keys(map) do
+    Map.new(map, fn {key, value} -> {List.to_atom(key), value} end)
+  end
+
   @doc """
   Runs the given function async.
   """
   def async_run(%Executable{} = executable, arguments, options \\ []) do
-    {data, _} = run(executable.client, executable, arguments, options, 1)
+    {data, _} = run(executable.client, executable, arguments, options, 1, 0)
     keep_on_device = Keyword.get(options, :keep_on_device, false)
     %{executable | async: {data, keep_on_device}}
   end
@@ -68,7 +108,7 @@ defmodule EXLA.Executable do
     end
   end
 
-  defp run(client, executable, arguments, options, async_run_int) do
+  defp run(client, executable, arguments, options, async_run_int, profile_int) do
     %{ref: exec, output_shape: output_shape} = executable
 
     run_id = Keyword.get(options, :run_id, System.unique_integer([:positive, :monotonic]))
@@ -108,7 +148,8 @@ defmodule EXLA.Executable do
             replica,
             partition,
             async_run_int,
-            keep_on_device_int
+            keep_on_device_int,
+            profile_int
           )
 
         _ ->
@@ -123,7 +164,8 @@ defmodule EXLA.Executable do
             replica,
             partition,
             async_run_int,
-            keep_on_device_int
+            keep_on_device_int,
+            profile_int
           )
       end
 
@@ -3,7 +3,7 @@ defmodule EXLA.Lib do
   High-level operations built on top of `EXLA.Op`.
   """
 
-  alias EXLA.{Builder, Op, Shape}
+  alias EXLA.{Builder, Computation, Op, Shape}
 
   @doc """
   Element-wise tangent function.
@@ -112,6 +112,178 @@ defmodule EXLA.Lib do
     Builder.build(ast)
   end
 
+  @doc """
+  Adds `updates` into `op` at the positions given by `indices`.
+
+  Repeated indices accumulate. `dimension_numbers` and `opts`
+  are the same as in `EXLA.Op.scatter/6`.
+  """
+  def scatter_add(
+        %Builder{} = builder,
+        %Op{} = op,
+        %Op{} = indices,
+        %Op{} = updates,
+        dimension_numbers,
+        opts \\ []
+      ) do
+    %Shape{dtype: type} = Op.get_shape(op)
+    add = add_computation(builder, type)
+    Op.scatter(op, indices, updates, add, dimension_numbers, opts)
+  end
+
+  @doc """
+  Builds a computation that adds two scalars of the given type.
+
+  It is the reducer used by `scatter_add/6` and `all_sum/3`.
+  """
+  def add_computation(%Builder{} = builder, type) do
+    sub_builder = subbuilder(builder, "add")
+    lhs = Op.parameter(sub_builder, 0, Shape.make_shape(type, {}), "lhs")
+    rhs = Op.parameter(sub_builder, 1, Shape.make_shape(type, {}), "rhs")
+    Builder.build(Op.add(lhs, rhs))
+  end
+
+  ## Quantization
+
+  @doc """
+  Quantizes the floating point `op` to the integer `type`.
+
+  `scale` and `zero_point` are floating point ops. They are either
+  scalars, when `axis` is `nil`, or vectors with one value per index
+  of `axis`, giving per-channel quantization. Each element `x` becomes
+  `round(x / scale) + zero_point`, clamped to the range of `type`.
+  """
+  def quantize(
+        %Builder{} = builder,
+        %Op{} = op,
+        %Op{} = scale,
+        %Op{} = zero_point,
+        axis,
+        type \\ {:s, 8}
+      ) do
+    %Shape{dtype: float_type} = Op.get_shape(op)
+    {min, max} = integer_range(type)
+    dims = channel_dims(axis)
+
+    op
+    |> Op.divide(to_float(scale, float_type), dims)
+    |> Op.round()
+    |> Op.add(to_float(zero_point, float_type), dims)
+    |> Op.clamp(
+      Op.constant_r0(builder, min, float_type),
+      Op.constant_r0(builder, max, float_type)
+    )
+    |> Op.convert_element_type(type)
+  end
+
+  @doc """
+  Dequantizes the integer `op` to the floating point `type`.
+
+  It is the inverse of `quantize/6`: each element `q` becomes
+  `(q - zero_point) * scale`, with `scale` and `zero_point` given
+  per index of `axis` or as scalars when `axis` is `nil`.
+  """
+  def dequantize(
+        %Builder{},
+        %Op{} = op,
+        %Op{} = scale,
+        %Op{} = zero_point,
+        axis,
+        type \\ {:f, 32}
+      ) do
+    dims = channel_dims(axis)
+
+    op
+    |> Op.convert_element_type(type)
+    |> Op.subtract(to_float(zero_point, type), dims)
+    |> Op.multiply(to_float(scale, type), dims)
+  end
+
+  defp channel_dims(nil), do: {}
+  defp channel_dims(axis) when is_integer(axis), do: {axis}
+
+  defp to_float(op, type) do
+    if Op.get_shape(op).dtype == type, do: op, else: Op.convert_element_type(op, type)
+  end
+
+  defp integer_range({:s, size}), do: {-Bitwise.bsl(1, size - 1), Bitwise.bsl(1, size - 1) - 1}
+  defp integer_range({:u, size}), do: {0, Bitwise.bsl(1, size) - 1}
+
+  ## Collectives
+
+  @doc """
+  Sums `op` across the replicas of each group.
+
+  See `EXLA.Op.all_reduce/3` for the format of `replica_groups`.
+  """
+  def all_sum(%Builder{} = builder, %Op{} = op, replica_groups \\ []) do
+    %Shape{dtype: type} = Op.get_shape(op)
+    Op.all_reduce(op, add_computation(builder, type), replica_groups)
+  end
+
+  @doc """
+  Reduces `op` across replicas with `reducer` and returns to each
+  replica its own block of the result along `dimension`.
+
+  `shard_count` is the number of replicas in each group and the size
+  of `dimension` must be divisible by it. Replica `i` of a group gets
+  the `i`-th block.
+
+  This is lowered to an all-reduce followed by a dynamic slice indexed
+  by the replica position, which XLA does not fuse into a single
+  reduce-scatter in this version.
+  """
+  def reduce_scatter(
+        %Builder{} = builder,
+        %Op{} = op,
+        %Computation{} = reducer,
+        dimension,
+        shard_count,
+        replica_groups \\ []
+      )
+      when is_integer(dimension) and is_integer(shard_count) and shard_count > 0 do
+    %Shape{dims: dims} = Op.get_shape(op)
+    size = elem(dims, dimension)
+
+    if rem(size, shard_count) != 0 do
+      raise ArgumentError,
+            "dimension #{dimension} of size #{size} is not divisible by shard count #{shard_count}"
+    end
+
+    block = div(size, shard_count)
+    reduced = Op.all_reduce(op, reducer, replica_groups)
+    position = replica_position(builder, replica_groups)
+    start = Op.multiply(position, Op.constant_r0(builder, block, {:u, 32}))
+    zero = Op.constant_r0(builder, 0, {:u, 32})
+
+    indices = for axis <- Nx.axes(dims), do: if(axis == dimension, do: start, else: zero)
+    sizes = dims |> put_elem(dimension, block) |> Tuple.to_list()
+    Op.dynamic_slice(reduced, indices, sizes)
+  end
+
+  defp replica_position(builder, []), do: Op.replica_id(builder)
+
+  defp replica_position(builder, replica_groups) do
+    positions =
+      for group <- replica_groups,
+          {replica, position} <- Enum.with_index(group),
+          into: %{},
+          do: {replica, position}
+
+    count = Enum.max(Map.keys(positions)) + 1
+
+    data =
+      for replica <- 0..(count - 1), into: <<>> do
+        <<Map.get(positions, replica, 0)::32-native-unsigned>>
+      end
+
+    table = Op.constant_from_binary(builder, data, Shape.make_shape({:u, 32}, {count}))
+
+    table
+    |> Op.dynamic_slice([Op.replica_id(builder)], [1])
+    |> Op.reshape({})
+  end
+
   @doc """
   Returns a minimum value scalar operator for the given type.
 
@@ -130,6 +302,123 @@ defmodule EXLA.Lib do
     Op.constant_from_binary(builder, max_value_binary(type), Shape.make_shape(type, {}))
   end
 
+  @doc """
+  Returns the `k` largest values along the last axis of `op`
+  and their `{:s, 32}` indices, as a tuple op.
+
+  On the `:host` platform, `{:f, 32}` operands are handled by
+  `host_top_k/3`, which runs in O(n log k) per row instead of
+  sorting every row. Otherwise it uses XLA's `TopK`.
+  """
+  def top_k(%Builder{} = builder, %Op{} = op, k, platform) do
+    case {platform, Op.get_shape(op)} do
+      {:host, %Shape{dtype: {:f, 32}, dims: dims}} when tuple_size(dims) > 0 ->
+        host_top_k(builder, op, k)
+
+      _ ->
+        Op.top_k(op, k)
+    end
+  end
+
+  ## Host kernels
+
+  @doc """
+  Returns the `k` largest values along the last axis of `op`
+  and their indices, using a native host kernel.
+
+  The result is a tuple op with the values and the `{:s, 32}`
+  indices, both with the last axis of size `k`. It costs
+  O(n log k) per row. Only `{:f, 32}` on the host platform
+  is supported.
+  """
+  def host_top_k(%Builder{} = builder, %Op{} = op, k) when is_integer(k) and k >= 0 do
+    {dims, batch, n} = host_kernel_dims!(op, "host_top_k")
+
+    if k > n do
+      raise ArgumentError, "k must be at most the size of the last axis (#{n}), got: #{k}"
+    end
+
+    out_dims = put_elem(dims, tuple_size(dims) - 1, k)
+    values_shape = Shape.make_shape({:f, 32}, {batch, k})
+    indices_shape = Shape.make_shape({:s, 32}, {batch, k})
+
+    result =
+      Op.custom_call(
+        builder,
+        "exla_top_k_f32",
+        [s64(builder, batch), s64(builder, n), s64(builder, k), Op.reshape(op, {batch, n})],
+        Shape.make_tuple_shape([values_shape, indices_shape])
+      )
+
+    Op.tuple(builder, [
+      Op.reshape(Op.get_tuple_element(result, 0), out_dims),
+      Op.reshape(Op.get_tuple_element(result, 1), out_dims)
+    ])
+  end
+
+  @doc """
+  Computes the softmax along the last axis of `op`, using a
+  native host kernel.
+
+  Only `{:f, 32}` on the host platform is supported.
+  """
+  def host_softmax(%Builder{} = builder, %Op{} = op) do
+    {dims, batch, n} = host_kernel_dims!(op, "host_softmax")
+
+    result =
+      Op.custom_call(
+        builder,
+        "exla_softmax_f32",
+        [s64(builder, batch), s64(builder, n), Op.reshape(op, {batch, n})],
+        Shape.make_shape({:f, 32}, {batch, n})
+      )
+
+    Op.reshape(result, dims)
+  end
+
+  @doc """
+  Normalizes `op` along its last axis and applies the `gamma`
+  scale and `beta` offset, using a native host kernel.
+
+  `gamma` and `beta` must have the size of the last axis of `op`.
+  Only `{:f, 32}` on the host platform is supported.
+  """
+  def host_layer_norm(%Builder{} = builder, %Op{} = op, %Op{} = gamma, %Op{} = beta, epsilon \\ 1.0e-5)
+      when is_number(epsilon) do
+    {dims, batch, n} = host_kernel_dims!(op, "host_layer_norm")
+
+    result =
+      Op.custom_call(
+        builder,
+        "exla_layer_norm_f32",
+        [
+          s64(builder, batch),
+          s64(builder, n),
+          Op.constant_r0(builder, epsilon, {:f, 32}),
+          Op.reshape(op, {batch, n}),
+          Op.reshape(gamma, {n}),
+          Op.reshape(beta, {n})
+        ],
+        Shape.make_shape({:f, 32}, {batch, n})
+      )
+
+    Op.reshape(result, dims)
+  end
+
+  defp host_kernel_dims!(op, name) do
+    case Op.get_shape(op) do
+      %Shape{dtype: {:f, 32}, dims: dims} when tuple_size(dims) > 0 ->
+        n = elem(dims, tuple_size(dims) - 1)
+        {dims, div(Nx.size(dims), max(n, 1)), n}
+
+      %Shape{} = shape ->
+        raise ArgumentError,
+              "#{name} expects a {:f, 32} operand with at least one axis, got: #{inspect(shape)}"
+    end
+  end
+
+  defp s64(builder, value), do: Op.constant_r0(builder, value, {:s, 64})
+
   defp subbuilder(%Builder{name: name} = builder, desc) do
     suffix = System.unique_integer([:positive])
     Builder.new(builder, name <> "-" <> desc <> "-" <> Integer.to_string(suffix))
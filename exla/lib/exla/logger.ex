@@ -3,31 +3,47 @@ defmodule EXLA.Logger do
   use GenServer
   require Logger
 
+  @severities %{info: 0, warning: 1, error: 2}
+
   def start_link(_opts) do
     GenServer.start_link(__MODULE__, :ok, name: __MODULE__)
   end
 
   @impl true
   def init(:ok) do
-    :ok = EXLA.NIF.start_log_sink(self())
+    config = Application.get_env(:exla, :logger, [])
+    level = Keyword.get(config, :level, :info)
+    max_per_second = Keyword.get(config, :max_per_second, 1000)
+
+    severity =
+      Map.get(@severities, level) ||
+        raise ArgumentError,
+              "expected :level in :exla :logger config to be one of " <>
+                "#{inspect(Map.keys(@severities))}, got: #{inspect(level)}"
+
+    :ok = EXLA.NIF.start_log_sink(self(), severity, max_per_second)
     {:ok, :unused_state}
   end
 
   @impl true
-  def handle_info({:info, msg, file, line}, state) do
-    Logger.info(msg, domain: [:xla], file: file, line: line)
-    {:noreply, state}
-  end
+  def handle_info({:log_batch, entries, dropped}, state) do
+    Enum.each(entries, &log/1)
 
-  @impl true
-  def handle_info({:warning, msg, file, line}, state) do
-    Logger.warning(msg, domain: [:xla], file: file, line: line)
-    {:noreply, state}
-  end
+    if dropped > 0 do
+      Logger.warning("dropped #{dropped} XLA log messages due to rate limiting",
+        domain: [:xla]
+      )
+    end
 
-  @impl true
-  def handle_info({:error, msg, file, line}, state) do
-    Logger.error(msg, domain: [:xla], file: file, line: line)
     {:noreply, state}
   end
+
+  defp log({:info, msg, file, line}),
+    do: Logger.info(msg, domain: [:xla], file: file, line: line)
+
+  defp log({:warning, msg, file, line}),
+    do: Logger.warning(msg, domain: [:xla], file: file, line: line)
+
+  defp log({:error, msg, file, line}),
+    do: Logger.error(msg, domain: [:xla], file: file, line: line)
 end
@@ -48,10 +48,13 @@ defmodule EXLA.NIF do
     end
   end
 
+  def elementwise(_operands, _program),
+    do: :erlang.nif_error(:undef)
+
   def dot(_a, _b, _precision),
     do: :erlang.nif_error(:undef)
 
-  def dot_general(_a, _b, _dims, _precision),
+  def dot_general(_a, _b, _dims, _precision, _preferred_type),
     do: :erlang.nif_error(:undef)
 
   def conv_general_dilated(
@@ -77,6 +80,9 @@ defmodule EXLA.NIF do
   def conditional(_index, _branches, _operands),
     do: :erlang.nif_error(:undef)
 
+  def while(_cond_comp, _body_comp, _init),
+    do: :erlang.nif_error(:undef)
+
   def select(_pred, _on_true, _on_false),
     do: :erlang.nif_error(:undef)
 
@@ -89,6 +95,44 @@ defmodule EXLA.NIF do
   def dynamic_update_slice(_op, _update, _start_indices),
     do: :erlang.nif_error(:undef)
 
+  def gather(_operand, _start_indices, _dimension_numbers, _slice_sizes, _indices_are_sorted),
+    do: :erlang.nif_error(:undef)
+
+  def scatter(
+        _operand,
+        _scatter_indices,
+        _updates,
+        _update_computation,
+        _dimension_numbers,
+        _indices_are_sorted,
+        _unique_indices
+      ),
+      do: :erlang.nif_error(:undef)
+
+  def all_reduce(_operand, _computation, _replica_groups),
+    do: :erlang.nif_error(:undef)
+
+  def all_gather(_operand, _all_gather_dimension, _shard_count, _replica_groups),
+    do: :erlang.nif_error(:undef)
+
+  def all_to_all(_operand, _split_dimension, _concat_dimension, _split_count, _replica_groups),
+    do: :erlang.nif_error(:undef)
+
+  def collective_permute(_operand, _source_target_pairs),
+    do: :erlang.nif_error(:undef)
+
+  def replica_id(_builder),
+    do: :erlang.nif_error(:undef)
+
+  def create_token(_builder),
+    do: :erlang.nif_error(:undef)
+
+  def infeed(_token, _shape),
+    do: :erlang.nif_error(:undef)
+
+  def outfeed(_operand, _token),
+    do: :erlang.nif_error(:undef)
+
   def rng_normal(_mu, _sigma, _shape),
     do: :erlang.nif_error(:undef)
 
@@ -161,6 +205,12 @@ defmodule EXLA.NIF do
   def concatenate(_builder, _operands, _dimension),
     do: :erlang.nif_error(:undef)
 
+  def custom_call(_builder, _call_target_name, _operands, _shape),
+    do: :erlang.nif_error(:undef)
+
+  def top_k(_operand, _k),
+    do: :erlang.nif_error(:undef)
+
   def sort(_operand, _comparator, _dimension),
     do: :erlang.nif_error(:undef)
 
@@ -192,6 +242,14 @@ defmodule EXLA.NIF do
 
   def get_supported_platforms, do: :erlang.nif_error(:undef)
 
+  def get_metrics(_client), do: :erlang.nif_error(:undef)
+
+  def start_trace, do: :erlang.nif_error(:undef)
+
+  def stop_trace, do: :erlang.nif_error(:undef)
+
+  def dump_trace, do: :erlang.nif_error(:undef)
+
   def get_default_device_ordinal(_client),
     do: :erlang.nif_error(:undef)
 
@@ -222,7 +280,8 @@ defmodule EXLA.NIF do
         _replica,
         _partition,
         _async_run,
-        _keep_on_device
+        _keep_on_device,
+        _profile
       ),
       do: :erlang.nif_error(:undef)
 
@@ -237,7 +296,8 @@ defmodule EXLA.NIF do
         _replica,
         _partition,
         _async_run,
-        _keep_on_device
+        _keep_on_device,
+        _profile
       ),
       do: :erlang.nif_error(:undef)
 
@@ -255,19 +315,32 @@ defmodule EXLA.NIF do
         _function_name,
         _class_name,
         _target_triple,
+        _target_cpu,
         _target_features
       ),
       do: :erlang.nif_error(:undef)
 
+  def run_hlo_passes(_computation, _passes),
+    do: :erlang.nif_error(:undef)
+
+  def get_cost_analysis(_executable, _partition),
+    do: :erlang.nif_error(:undef)
+
   def binary_to_device_mem(_client, _binary, _shape, _device_ordinal),
     do: :erlang.nif_error(:undef)
 
+  def transfer_to_infeed(_client, _device_ordinal, _data, _shape),
+    do: :erlang.nif_error(:undef)
+
+  def transfer_from_outfeed(_client, _device_ordinal, _shape),
+    do: :erlang.nif_error(:undef)
+
   def read_device_mem(_client, _buffer),
     do: :erlang.nif_error(:undef)
 
   def deallocate_device_mem(_buffer),
     do: :erlang.nif_error(:undef)
 
-  def start_log_sink(_sink_pid),
+  def start_log_sink(_sink_pid, _min_severity, _max_per_second),
     do: :erlang.nif_error(:undef)
 end
@@ -163,6 +163,40 @@ defmodule EXLA.Op do
     end
   end
 
+  ## Fused element-wise ops
+
+  @doc """
+  Builds an element-wise expression over `operands` in a single call.
+
+  `program` is a list of instructions in postfix order, evaluated
+  on a stack:
+
+    * `{:operand, index}` - pushes the operand at `index`
+    * `{:unary, name}` - applies the unary op `name` to the top of the stack
+    * `{:binary, name, broadcast_dims}` - applies the binary op `name`
+      to the two values on top of the stack
+
+  The names are the ones of the element-wise functions in this module.
+  For example, `logistic(x * y + z) * x` is written as:
+
+      Op.elementwise([x, y, z], [
+        {:operand, 0},
+        {:operand, 1},
+        {:binary, :multiply, {}},
+        {:operand, 2},
+        {:binary, :add, {}},
+        {:unary, :logistic},
+        {:operand, 0},
+        {:binary, :multiply, {}}
+      ])
+
+  """
+  def elementwise([%Op{builder: builder} | _] = operands, program) when is_list(program) do
+    refs = Enum.map(operands, fn %Op{builder: ^builder, ref: ref} -> ref end)
+    ref = EXLA.NIF.elementwise(refs, program) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
   ## Ops
 
   def get_tuple_element(%Op{ref: operand} = op, index) when is_integer(index) do
@@ -194,6 +228,21 @@ defmodule EXLA.Op do
     %Op{builder: builder, ref: ref}
   end
 
+  @doc """
+  Builds a loop that applies `body` to `init` while `condition`
+  returns true.
+
+  Both computations receive a single parameter with the shape of
+  `init`. `condition` must return a `{:pred, 8}` scalar and `body`
+  must return a value with the shape of `init`. The loop runs
+  entirely on the device.
+  """
+  def while(%Computation{ref: cond_comp}, %Computation{ref: body_comp}, %Op{} = init) do
+    %Op{builder: builder, ref: init_ref} = init
+    ref = EXLA.NIF.while(cond_comp, body_comp, init_ref) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
   def select(
         %Op{builder: builder, ref: pred},
         %Op{builder: builder, ref: on_true},
@@ -236,6 +285,195 @@ defmodule EXLA.Op do
     %Op{builder: builder, ref: ref}
   end
 
+  @doc """
+  Gathers slices of `operand` at the positions given by `indices`.
+
+  `dimension_numbers` is a keyword list with:
+
+    * `:offset_dims` - the output dimensions that index into the slices
+    * `:collapsed_slice_dims` - the slice dimensions of size 1 to drop
+    * `:start_index_map` - the operand dimension each index refers to
+    * `:index_vector_dim` - the dimension of `indices` holding the index vectors
+
+  See the XLA `Gather` semantics for details.
+
+  ## Options
+
+    * `:indices_are_sorted` - whether the indices are sorted. Defaults to `false`
+  """
+  def gather(
+        %Op{builder: builder, ref: operand},
+        %Op{builder: builder, ref: indices},
+        dimension_numbers,
+        slice_sizes,
+        opts \\ []
+      )
+      when is_list(dimension_numbers) and is_list(slice_sizes) do
+    dimnos = {
+      Keyword.fetch!(dimension_numbers, :offset_dims),
+      Keyword.fetch!(dimension_numbers, :collapsed_slice_dims),
+      Keyword.fetch!(dimension_numbers, :start_index_map),
+      Keyword.fetch!(dimension_numbers, :index_vector_dim)
+    }
+
+    sorted = boolean_to_int(Keyword.get(opts, :indices_are_sorted, false))
+    ref = EXLA.NIF.gather(operand, indices, dimnos, slice_sizes, sorted) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Combines `updates` into `operand` at the positions given by `indices`,
+  using `computation` to merge each update with the current value.
+
+  `dimension_numbers` is a keyword list with:
+
+    * `:update_window_dims` - the dimensions of `updates` that are window dimensions
+    * `:inserted_window_dims` - the window dimensions of size 1 missing from `updates`
+    * `:scatter_dims_to_operand_dims` - the operand dimension each index refers to
+    * `:index_vector_dim` - the dimension of `indices` holding the index vectors
+
+  See the XLA `Scatter` semantics for details and `EXLA.Lib.scatter_add/5`
+  for the common case of accumulating updates.
+
+  ## Options
+
+    * `:indices_are_sorted` - whether the indices are sorted. Defaults to `false`
+    * `:unique_indices` - whether the indices are unique. Defaults to `false`
+  """
+  def scatter(
+        %Op{builder: builder, ref: operand},
+        %Op{builder: builder, ref: indices},
+        %Op{builder: builder, ref: updates},
+        %Computation{ref: computation},
+        dimension_numbers,
+        opts \\ []
+      )
+      when is_list(dimension_numbers) do
+    dimnos = {
+      Keyword.fetch!(dimension_numbers, :update_window_dims),
+      Keyword.fetch!(dimension_numbers, :inserted_window_dims),
+      Keyword.fetch!(dimension_numbers, :scatter_dims_to_operand_dims),
+      Keyword.fetch!(dimension_numbers, :index_vector_dim)
+    }
+
+    sorted = boolean_to_int(Keyword.get(opts, :indices_are_sorted, false))
+    unique = boolean_to_int(Keyword.get(opts, :unique_indices, false))
+
+    ref =
+      EXLA.NIF.scatter(operand, indices, updates, computation, dimnos, sorted, unique)
+      |> unwrap!()
+
+    %Op{builder: builder, ref: ref}
+  end
+
+  ## Infeed/Outfeed
+
+  @doc """
+  Creates a token to order side-effecting ops such as `infeed/2`
+  and `outfeed/2`.
+  """
+  def create_token(%Builder{ref: builder}) do
+    ref = EXLA.NIF.create_token(builder) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Reads a value of `shape` from the device infeed queue.
+
+  Returns a tuple op with the value and a new token. Values are
+  enqueued with `EXLA.Client.transfer_to_infeed/4`.
+  """
+  def infeed(%Op{builder: builder, ref: token}, %Shape{ref: shape}) do
+    ref = EXLA.NIF.infeed(token, shape) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Writes `operand` to the device outfeed queue and returns a new token.
+
+  Values are dequeued with `EXLA.Client.transfer_from_outfeed/3`.
+  """
+  def outfeed(%Op{builder: builder, ref: operand}, %Op{builder: builder, ref: token}) do
+    ref = EXLA.NIF.outfeed(operand, token) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  ## Collectives
+
+  @doc """
+  Reduces `operand` across replicas with `computation`.
+
+  Every replica receives the reduced value. `replica_groups` is a
+  list of lists of replica ids; reductions only happen within a
+  group. An empty list (the default) puts all replicas in one group.
+  """
+  def all_reduce(
+        %Op{builder: builder, ref: operand},
+        %Computation{ref: comp},
+        replica_groups \\ []
+      )
+      when is_list(replica_groups) do
+    ref = EXLA.NIF.all_reduce(operand, comp, replica_groups) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Concatenates `operand` from every replica in a group along `dimension`.
+
+  `shard_count` is the number of replicas in each group.
+  """
+  def all_gather(
+        %Op{builder: builder, ref: operand},
+        dimension,
+        shard_count,
+        replica_groups \\ []
+      )
+      when is_integer(dimension) and is_integer(shard_count) and is_list(replica_groups) do
+    ref = EXLA.NIF.all_gather(operand, dimension, shard_count, replica_groups) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Splits `operand` into `split_count` blocks along `split_dimension`,
+  sends block `i` to the `i`-th replica of the group and concatenates
+  the received blocks along `concat_dimension`.
+  """
+  def all_to_all(
+        %Op{builder: builder, ref: operand},
+        split_dimension,
+        concat_dimension,
+        split_count,
+        replica_groups \\ []
+      )
+      when is_integer(split_dimension) and is_integer(concat_dimension) and
+             is_integer(split_count) and is_list(replica_groups) do
+    ref =
+      EXLA.NIF.all_to_all(operand, split_dimension, concat_dimension, split_count, replica_groups)
+      |> unwrap!()
+
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Sends `operand` from each source replica to its target replica.
+
+  `source_target_pairs` is a list of `{source, target}` replica ids.
+  Replicas that are not a target receive zeros.
+  """
+  def collective_permute(%Op{builder: builder, ref: operand}, source_target_pairs)
+      when is_list(source_target_pairs) do
+    ref = EXLA.NIF.collective_permute(operand, source_target_pairs) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Returns the id of the replica running the computation as a `{:u, 32}` scalar.
+  """
+  def replica_id(%Builder{ref: builder}) do
+    ref = EXLA.NIF.replica_id(builder) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
   def dot(
         %Op{builder: builder, ref: left},
         %Op{builder: builder, ref: right},
@@ -246,14 +484,23 @@ defmodule EXLA.Op do
     %Op{builder: builder, ref: ref}
   end
 
+  @doc """
+  Computes the dot product of `left` and `right` over the contracting
+  dimensions in `dimnos`.
+
+  `preferred_type` sets the result type, such as `{:s, 32}` for
+  `{:s, 8}` operands. When `nil`, the result has the operand type.
+  """
   def dot_general(
         %Op{builder: builder, ref: left},
         %Op{builder: builder, ref: right},
         dimnos,
-        precision_config
+        precision_config,
+        preferred_type \\ nil
       ) do
     config = get_precision_config_int(precision_config)
-    ref = EXLA.NIF.dot_general(left, right, dimnos, config) |> unwrap!()
+    preferred_type = preferred_type && Shape.dtype_to_charlist(preferred_type)
+    ref = EXLA.NIF.dot_general(left, right, dimnos, config, preferred_type) |> unwrap!()
     %Op{builder: builder, ref: ref}
   end
 
@@ -494,6 +741,32 @@ defmodule EXLA.Op do
     %Op{builder: builder, ref: ref}
   end
 
+  @doc """
+  Returns the `k` largest values along the last dimension of
+  `operand` and their `{:s, 32}` indices, as a tuple op.
+
+  Leading dimensions are treated as batch dimensions. See
+  `EXLA.Lib.top_k/4` for a version that uses a partial selection
+  kernel on the host.
+  """
+  def top_k(%Op{builder: builder, ref: operand}, k) when is_integer(k) and k >= 0 do
+    ref = EXLA.NIF.top_k(operand, k) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
+  @doc """
+  Calls the custom call target `name` with the given operands.
+
+  `shape` is the shape of the result. See `EXLA.Lib` for the
+  host kernels shipped with EXLA.
+  """
+  def custom_call(%Builder{ref: builder}, name, operands, %Shape{ref: shape})
+      when is_binary(name) and is_list(operands) do
+    operand_refs = Enum.map(operands, fn %Op{builder: ^builder, ref: ref} -> ref end)
+    ref = EXLA.NIF.custom_call(builder, name, operand_refs, shape) |> unwrap!()
+    %Op{builder: builder, ref: ref}
+  end
+
   ## Helpers
 
   defp get_precision_config_int(precision_config) do
@@ -0,0 +1,47 @@
+defmodule EXLA.Trace do
+  @moduledoc """
+  Records a timeline of native EXLA events.
+
+  When started, EXLA records when computations are compiled and run
+  and when buffers are transferred between host and device, including
+  the thread, device and stream of each event. The events can be
+  dumped in the Chrome trace event format, which can be opened in
+  `chrome://tracing` or [Perfetto](https://ui.perfetto.dev):
+
+      EXLA.Trace.start()
+      # run your computations
+      EXLA.Trace.stop()
+      File.write!("exla.json", EXLA.Trace.dump())
+
+  Events are kept in a fixed-size ring buffer, so only the most
+  recent events are kept on long traces. Tracing is global to the
+  node and has nearly no cost when it is not running.
+  """
+
+  @doc """
+  Clears previously recorded events and starts tracing.
+  """
+  def start do
+    EXLA.NIF.start_trace() |> unwrap!()
+  end
+
+  @doc """
+  Stops tracing.
+
+  Recorded events are kept until tracing is started again.
+  """
+  def stop do
+    EXLA.NIF.stop_trace() |> unwrap!()
+  end
+
+  @doc """
+  Returns the recorded events as a Chrome trace JSON binary.
+  """
+  def dump do
+    EXLA.NIF.dump_trace() |> unwrap!()
+  end
+
+  defp unwrap!(:ok), do: :ok
+  defp unwrap!({:ok, ref}), do: ref
+  defp unwrap!({:error, error}), do: raise(List.to_string(error))
+end
@@ -25,7 +25,7 @@ defmodule EXLA.MixProject do
     [
       extra_applications: [:logger],
       mod: {EXLA.Application, []},
-      env: [clients: [default: []]]
+      env: [clients: [default: []], logger: [level: :info, max_per_second: 1000]]
     ]
   end
 
@@ -791,6 +791,56 @@ defmodule EXLA.DefnExprTest do
     end
   end
 
+  describe "while" do
+    defn factorial(n) do
+      {_n, _i, acc} =
+        while({n, 1, 1}, fn {n, i, _acc} -> i <= n end, fn {n, i, acc} ->
+          {n, i + 1, acc * i}
+        end)
+
+      acc
+    end
+
+    test "runs the loop on the device" do
+      assert factorial(Nx.tensor(5)) == Nx.tensor(120)
+      assert factorial(Nx.tensor(0)) == Nx.tensor(1)
+    end
+
+    defn gradient_descent(w, x, y) do
+      {w, _x, _y, _i} =
+        while({w, x, y, 0}, fn {_w, _x, _y, i} -> i < 100 end, fn {w, x, y, i} ->
+          grad = 2 * Nx.dot(x, Nx.dot(x, w) - y) / Nx.size(y)
+          {w - 0.1 * grad, x, y, i + 1}
+        end)
+
+      w
+    end
+
+    test "carries tensors through the loop state" do
+      x = Nx.tensor([[1.0, 0.0], [0.0, 1.0]])
+      y = Nx.tensor([2.0, -3.0])
+      compare_tensors!(gradient_descent(Nx.tensor([0.0, 0.0]), x, y), y, atol: 1.0e-3)
+    end
+
+    defn nested_loops(n) do
+      {_n, _i, total} =
+        while({n, 0, 0}, fn {n, i, _total} -> i < n end, fn {n, i, total} ->
+          {_j, inner} =
+            while({0, total}, fn {j, _total} -> j < 3 end, fn {j, total} ->
+              {j + 1, total + 1}
+            end)
+
+          {n, i + 1, inner}
+        end)
+
+      total
+    end
+
+    test "with nested loops" do
+      assert nested_loops(Nx.tensor(4)) == Nx.tensor(12)
+    end
+  end
+
   describe "map" do
     defn map_plus(t), do: Nx.map(t, fn x -> x + 1 end)
     defn map_equal(t), do: Nx.map(t, [type: {:f, 64}], fn x -> Nx.equal(x, 1) end)
@@ -1581,6 +1631,26 @@ defmodule EXLA.DefnExprTest do
     end
   end
 
+  describe "quantized dot product" do
+    @weights Nx.tensor([[0.5, -1.0], [0.25, 2.0], [-0.75, 1.5]])
+    defn float_dense(x), do: Nx.dot(x, @weights)
+    @defn_compiler {EXLA, quantize_weights: true}
+    defn quantized_dense(x), do: Nx.dot(x, @weights)
+    @defn_compiler {EXLA, quantize_weights: true}
+    defn quantized_dot(a, b), do: Nx.dot(a, b)
+
+    test "approximates the float result for constant weights" do
+      x = Nx.tensor([[1.0, 2.0, 3.0], [-0.5, 0.0, 4.0]])
+      compare_tensors!(quantized_dense(x), float_dense(x), atol: 5.0e-2, rtol: 1.0e-2)
+    end
+
+    test "leaves dot products with runtime weights untouched" do
+      a = Nx.tensor([[1.0, 2.0, 3.0]])
+      b = Nx.tensor([[0.1], [0.2], [0.3]])
+      compare_tensors!(quantized_dot(a, b), dot(a, b))
+    end
+  end
+
   describe "convolution" do
     defn conv_valid_no_stride(inp, kernel), do: Nx.conv(inp, kernel)
 
@@ -20,6 +20,316 @@ defmodule EXLA.ExecutableTest do
     end
   end
 
+  describe "hlo passes" do
+    test "shrink the computation and report instruction counts" do
+      t1 = %Buffer{data: <<1::32-native>>, shape: Shape.make_shape({:s, 32}, {})}
+
+      passes = ["constant_folding", "algsimp", "cse", "dce"]
+
+      fun = fn b, x ->
+        _unused = Op.multiply(x, x)
+        one = Op.add(Op.constant_r0(b, 1, {:s, 32}), Op.constant_r0(b, 0, {:s, 32}))
+        Op.tuple(b, [Op.add(x, one)])
+      end
+
+      exec = compile([t1.shape], fun, hlo_passes: passes)
+
+      assert %{instructions_before: before, instructions_after: after_passes, changed: true} =
+               exec.pass_report
+
+      assert after_passes < before
+      assert [%Buffer{data: <<2::32-native>>}] = Executable.run(exec, [t1])
+    end
+
+    test "raise on unknown passes" do
+      assert_raise RuntimeError, ~r"Unknown HLO pass: unknown", fn ->
+        compile([], fn b -> Op.tuple(b, [Op.constant_r0(b, 1, {:s, 32})]) end,
+          hlo_passes: ["unknown"]
+        )
+      end
+    end
+  end
+
+  describe "profiling" do
+    test "returns the cost analysis" do
+      t1 = %Buffer{data: <<1::32-native>>, shape: Shape.make_shape({:f, 32}, {})}
+      exec = compile([t1.shape, t1.shape], fn b, x, y -> Op.tuple(b, [Op.add(x, y)]) end)
+
+      assert %{flops: flops, bytes_accessed: bytes, transcendentals: +0.0} =
+               Executable.cost_analysis(exec)
+
+      assert flops >= 1.0
+      assert bytes > 0.0
+    end
+
+    test "returns the execution profile alongside the output" do
+      t1 = %Buffer{data: <<1::32-native>>, shape: Shape.make_shape({:s, 32}, {})}
+      exec = compile([t1.shape, t1.shape], fn b, x, y -> Op.tuple(b, [Op.add(x, y)]) end)
+
+      assert {[%Buffer{data: <<2::32-native>>}], profile} =
+               Executable.run_with_profile(exec, [t1, t1])
+
+      assert %{compute_time_ns: _, compute_cycle_count: _, compute_and_transfer_time_ns: _} =
+               profile
+    end
+  end
+
+  describe "metrics" do
+    test "records compile and run latencies" do
+      t1 = %Buffer{data: <<1::32-native>>, shape: Shape.make_shape({:s, 32}, {})}
+
+      assert [%Buffer{data: <<2::32-native>>}] =
+               run([t1, t1], fn b, x, y -> Op.tuple(b, [Op.add(x, y)]) end)
+
+      assert %{client: %{compile: compile}, devices: devices} = EXLA.Client.get_metrics(client())
+      assert compile.count >= 1
+      assert compile.p50 <= compile.p99
+
+      assert %{run_async: run_async, block_host_until_done: _} =
+               Map.fetch!(devices, client().default_device_ordinal)
+
+      assert run_async.count >= 1
+      assert Enum.sum(Enum.map(run_async.buckets, &elem(&1, 1))) == run_async.count
+    end
+  end
+
+  describe "host kernels" do
+    defp f32_buffer(values, dims) do
+      data = for v <- values, into: <<>>, do: <<v::float-32-native>>
+      %Buffer{data: data, shape: Shape.make_shape({:f, 32}, dims)}
+    end
+
+    test "top_k" do
+      t = f32_buffer([3.0, 1.0, 4.0, 1.5, 0.0, 2.0, -1.0, 5.0], {2, 4})
+
+      assert [%Buffer{data: values}, %Buffer{data: indices}] =
+               run([t], fn b, x ->
+                 result = EXLA.Lib.host_top_k(b, x, 2)
+                 Op.tuple(b, [Op.get_tuple_element(result, 0), Op.get_tuple_element(result, 1)])
+               end)
+
+      assert values ==
+               <<4.0::float-32-native, 3.0::float-32-native, 5.0::float-32-native,
+                 2.0::float-32-native>>
+
+      assert indices == <<2::32-native, 0::32-native, 3::32-native, 1::32-native>>
+    end
+
+    test "top_k with XLA's TopK matches the host kernel" do
+      t = f32_buffer([3.0, 1.0, 4.0, 1.5, 0.0, 2.0, -1.0, 5.0], {2, 4})
+
+      fun = fn platform ->
+        fn b, x ->
+          result = EXLA.Lib.top_k(b, x, 3, platform)
+          Op.tuple(b, [Op.get_tuple_element(result, 0), Op.get_tuple_element(result, 1)])
+        end
+      end
+
+      assert [%Buffer{data: values}, %Buffer{data: indices}] = run([t], fun.(:cuda))
+      assert [%Buffer{data: ^values}, %Buffer{data: ^indices}] = run([t], fun.(:host))
+
+      assert indices ==
+               <<2::32-native, 0::32-native, 3::32-native, 3::32-native, 1::32-native,
+                 0::32-native>>
+    end
+
+    test "softmax" do
+      t = f32_buffer([0.0, 0.0, 1.0, 1.0], {2, 2})
+
+      assert [%Buffer{data: data}] =
+               run([t], fn b, x -> Op.tuple(b, [EXLA.Lib.host_softmax(b, x)]) end)
+
+      assert data ==
+               <<0.5::float-32-native, 0.5::float-32-native, 0.5::float-32-native,
+                 0.5::float-32-native>>
+    end
+
+    test "layer_norm" do
+      t = f32_buffer([1.0, 3.0], {1, 2})
+      gamma = f32_buffer([2.0, 2.0], {2})
+      beta = f32_buffer([1.0, 1.0], {2})
+
+      assert [%Buffer{data: data}] =
+               run([t, gamma, beta], fn b, x, g, bt ->
+                 Op.tuple(b, [EXLA.Lib.host_layer_norm(b, x, g, bt, 0.0)])
+               end)
+
+      assert data == <<-1.0::float-32-native, 3.0::float-32-native>>
+    end
+  end
+
+  describe "gather and scatter" do
+    defp s32_buffer(values, dims) do
+      data = for v <- values, into: <<>>, do: <<v::32-native>>
+      %Buffer{data: data, shape: Shape.make_shape({:s, 32}, dims)}
+    end
+
+    test "gather looks up rows" do
+      table = f32_buffer([0.0, 1.0, 10.0, 11.0, 20.0, 21.0], {3, 2})
+      indices = s32_buffer([2, 0, 2], {3})
+
+      dimension_numbers = [
+        offset_dims: [1],
+        collapsed_slice_dims: [0],
+        start_index_map: [0],
+        index_vector_dim: 1
+      ]
+
+      assert [%Buffer{data: data, shape: %Shape{dims: {3, 2}}}] =
+               run([table, indices], fn b, t, i ->
+                 Op.tuple(b, [Op.gather(t, i, dimension_numbers, [1, 2])])
+               end)
+
+      assert data ==
+               <<20.0::float-32-native, 21.0::float-32-native, 0.0::float-32-native,
+                 1.0::float-32-native, 20.0::float-32-native, 21.0::float-32-native>>
+    end
+
+    test "scatter_add accumulates repeated indices" do
+      table = f32_buffer([0.0, 0.0, 0.0, 0.0, 0.0, 0.0], {3, 2})
+      indices = s32_buffer([2, 0, 2], {3})
+      updates = f32_buffer([1.0, 2.0, 3.0, 4.0, 5.0, 6.0], {3, 2})
+
+      dimension_numbers = [
+        update_window_dims: [1],
+        inserted_window_dims: [0],
+        scatter_dims_to_operand_dims: [0],
+        index_vector_dim: 1
+      ]
+
+      assert [%Buffer{data: data}] =
+               run([table, indices, updates], fn b, t, i, u ->
+                 Op.tuple(b, [EXLA.Lib.scatter_add(b, t, i, u, dimension_numbers)])
+               end)
+
+      assert data ==
+               <<3.0::float-32-native, 4.0::float-32-native, 0.0::float-32-native,
+                 0.0::float-32-native, 6.0::float-32-native, 8.0::float-32-native>>
+    end
+  end
+
+  describe "quantization" do
+    test "quantize and dequantize round trip with per-channel scales" do
+      t = f32_buffer([1.0, -2.0, 3.0, 0.5, 10.0, -10.0], {3, 2})
+      scale = f32_buffer([0.1, 0.5], {2})
+
+      assert [%Buffer{data: quantized, shape: %Shape{dtype: {:s, 8}}}, %Buffer{data: data}] =
+               run([t, scale], fn b, x, s ->
+                 zero = Op.constant_r0(b, 0, {:f, 32})
+                 q = EXLA.Lib.quantize(b, x, s, zero, 1)
+                 Op.tuple(b, [q, EXLA.Lib.dequantize(b, q, s, zero, 1)])
+               end)
+
+      assert quantized == <<10::8-signed, -4::8-signed, 30::8-signed, 1::8, 100::8, -20::8-signed>>
+
+      assert data ==
+               <<1.0::float-32-native, -2.0::float-32-native, 3.0::float-32-native,
+                 0.5::float-32-native, 10.0::float-32-native, -10.0::float-32-native>>
+    end
+
+    test "quantize saturates to the integer range" do
+      t = f32_buffer([1000.0, -1000.0], {2})
+
+      assert [%Buffer{data: data}] =
+               run([t], fn b, x ->
+                 one = Op.constant_r0(b, 1, {:f, 32})
+                 zero = Op.constant_r0(b, 0, {:f, 32})
+                 Op.tuple(b, [EXLA.Lib.quantize(b, x, one, zero, nil)])
+               end)
+
+      assert data == <<127::8-signed, -128::8-signed>>
+    end
+
+    test "dot_general accumulates int8 operands in a wider type" do
+      t = %Buffer{data: <<100::8-signed, 100::8-signed>>, shape: Shape.make_shape({:s, 8}, {2})}
+
+      assert [%Buffer{data: <<20000::32-signed-native>>, shape: %Shape{dtype: {:s, 32}}}] =
+               run([t], fn b, x ->
+                 Op.tuple(b, [Op.dot_general(x, x, {[0], [0]}, :default, {:s, 32})])
+               end)
+    end
+  end
+
+  describe "collectives" do
+    test "all_sum, all_gather and collective_permute on a single replica" do
+      t = f32_buffer([1.0, 2.0, 3.0, 4.0], {4})
+
+      assert [%Buffer{data: sum}, %Buffer{data: gathered}, %Buffer{data: permuted}] =
+               run([t], fn b, x ->
+                 Op.tuple(b, [
+                   EXLA.Lib.all_sum(b, x),
+                   Op.all_gather(x, 0, 1),
+                   Op.collective_permute(x, [{0, 0}])
+                 ])
+               end)
+
+      assert sum == t.data
+      assert gathered == t.data
+      assert permuted == t.data
+    end
+
+    test "reduce_scatter returns the block of the current replica" do
+      t = f32_buffer([1.0, 2.0, 3.0, 4.0], {2, 2})
+
+      assert [%Buffer{data: data, shape: %Shape{dims: {2, 2}}}, %Buffer{data: <<0::32-native>>}] =
+               run([t], fn b, x ->
+                 add = EXLA.Lib.add_computation(b, {:f, 32})
+                 Op.tuple(b, [EXLA.Lib.reduce_scatter(b, x, add, 0, 1, [[0]]), Op.replica_id(b)])
+               end)
+
+      assert data == t.data
+    end
+  end
+
+  describe "infeed and outfeed" do
+    test "streams values through a running loop" do
+      shape = Shape.make_shape({:f, 32}, {2})
+      counter = %Buffer{data: <<0::32-native>>, shape: Shape.make_shape({:s, 32}, {})}
+
+      exec =
+        compile([counter.shape], fn b, n ->
+          cond_b = EXLA.Builder.new(b, "infeed-cond")
+          state = Op.parameter(cond_b, 0, Shape.make_tuple_shape([counter.shape]), "state")
+          i = Op.get_tuple_element(state, 0)
+          cond_comp = EXLA.Builder.build(Op.less(i, Op.constant_r0(cond_b, 3, {:s, 32})))
+
+          body_b = EXLA.Builder.new(b, "infeed-body")
+          state = Op.parameter(body_b, 0, Shape.make_tuple_shape([counter.shape]), "state")
+          i = Op.get_tuple_element(state, 0)
+          token = Op.create_token(body_b)
+          received = Op.infeed(token, shape)
+          value = Op.get_tuple_element(received, 0)
+          token = Op.get_tuple_element(received, 1)
+          doubled = Op.multiply(value, Op.constant_r0(body_b, 2.0, {:f, 32}))
+          _token = Op.outfeed(doubled, token)
+          next = Op.add(i, Op.constant_r0(body_b, 1, {:s, 32}))
+          body_comp = EXLA.Builder.build(Op.tuple(body_b, [next]))
+
+          result = Op.while(cond_comp, body_comp, Op.tuple(b, [n]))
+          Op.tuple(b, [Op.get_tuple_element(result, 0)])
+        end)
+
+      for i <- 1..3 do
+        :ok = EXLA.Client.transfer_to_infeed(client(), 0, f32_binary([i, i + 0.5]), shape)
+      end
+
+      reader =
+        Task.async(fn ->
+          for _ <- 1..3, do: EXLA.Client.transfer_from_outfeed(client(), 0, shape)
+        end)
+
+      assert [%Buffer{data: <<3::32-native>>}] = Executable.run(exec, [counter])
+
+      assert Task.await(reader) == [
+               f32_binary([2.0, 3.0]),
+               f32_binary([4.0, 5.0]),
+               f32_binary([6.0, 7.0])
+             ]
+    end
+
+    defp f32_binary(values), do: for(v <- values, into: <<>>, do: <<v::float-32-native>>)
+  end
+
   describe "run" do
     test "succeeds with no inputs and default options" do
       assert [%Buffer{data: <<1::32-native>>}] =
@@ -214,6 +214,53 @@ defmodule EXLA.OpTest do
     assert %Op{} = Op.add(a, b)
   end
 
+  describe "elementwise/2" do
+    test "builds the whole expression" do
+      t1 = %EXLA.Buffer{data: <<2.0::float-32-native>>, shape: Shape.make_shape({:f, 32}, {})}
+      t2 = %EXLA.Buffer{data: <<3.0::float-32-native>>, shape: Shape.make_shape({:f, 32}, {})}
+
+      program = [
+        {:operand, 0},
+        {:operand, 1},
+        {:binary, :multiply, {}},
+        {:operand, 0},
+        {:binary, :subtract, {}},
+        {:unary, :negate}
+      ]
+
+      assert [%EXLA.Buffer{data: <<-4.0::float-32-native>>}] =
+               EXLAHelpers.run([t1, t2], fn b, x, y ->
+                 Op.tuple(b, [Op.elementwise([x, y], program)])
+               end)
+    end
+
+    test "broadcasts operands" do
+      builder = Builder.new("test")
+      x = Op.parameter(builder, 0, Shape.make_shape({:f, 32}, {2, 3}), "x")
+      y = Op.parameter(builder, 1, Shape.make_shape({:f, 32}, {3}), "y")
+
+      op = Op.elementwise([x, y], [{:operand, 0}, {:operand, 1}, {:binary, :add, {1}}])
+      assert %Shape{dims: {2, 3}, dtype: {:f, 32}} = Op.get_shape(op)
+    end
+
+    test "raises on invalid programs" do
+      builder = Builder.new("test")
+      x = Op.parameter(builder, 0, Shape.make_shape({:f, 32}, {}), "x")
+
+      assert_raise RuntimeError, ~r"Unknown unary op: unknown", fn ->
+        Op.elementwise([x], [{:operand, 0}, {:unary, :unknown}])
+      end
+
+      assert_raise RuntimeError, ~r"Stack underflow", fn ->
+        Op.elementwise([x], [{:operand, 0}, {:binary, :add, {}}])
+      end
+
+      assert_raise RuntimeError, ~r"exactly one value", fn ->
+        Op.elementwise([x], [{:operand, 0}, {:operand, 0}])
+      end
+    end
+  end
+
   test "dot/3 successfully creates dot op" do
     builder = Builder.new("test")
     shape = Shape.make_shape({:s, 32}, {1, 1})
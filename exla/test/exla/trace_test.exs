@@ -0,0 +1,34 @@
+defmodule EXLA.TraceTest do
+  use ExUnit.Case, async: false
+
+  alias EXLA.{Buffer, Op, Shape}
+
+  import EXLAHelpers
+
+  test "records compile, transfer and run events" do
+    t1 = %Buffer{data: <<1::32-native>>, shape: Shape.make_shape({:s, 32}, {})}
+
+    :ok = EXLA.Trace.start()
+
+    assert [%Buffer{data: <<2::32-native>>}] =
+             run([t1, t1], fn b, x, y -> Op.tuple(b, [Op.add(x, y)]) end)
+
+    :ok = EXLA.Trace.stop()
+
+    trace = EXLA.Trace.dump()
+    assert trace =~ ~s("traceEvents":[)
+    assert trace =~ ~s("name":"compile")
+    assert trace =~ ~s("name":"buffer_from_binary")
+    assert trace =~ ~s("name":"run")
+  end
+
+  test "does not record when stopped" do
+    :ok = EXLA.Trace.start()
+    :ok = EXLA.Trace.stop()
+    trace = EXLA.Trace.dump()
+
+    compile([], fn b -> Op.tuple(b, [Op.constant_r0(b, 1, {:s, 32})]) end)
+
+    assert EXLA.Trace.dump() == trace
+  end
+end
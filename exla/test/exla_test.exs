@@ -5,6 +5,8 @@ defmodule EXLATest do
   @compile {:no_warn_undefined, ExpAotDemo}
   @compile {:no_warn_undefined, ExpExportDemo}
   @compile {:no_warn_undefined, ComplexAotDemo}
+  @compile {:no_warn_undefined, VariantsAotDemo}
+  @compile {:no_warn_undefined, ConcurrentAotDemo}
 
   doctest EXLA
 
@@ -36,4 +38,42 @@ defmodule EXLATest do
     assert ComplexAotDemo.dot(dot1, dot2) == dot1
     assert ComplexAotDemo.dot(dot2, dot1) == dot1
   end
+
+  test "aot with target cpu variants" do
+    dot1 = Nx.iota({3, 3}, type: {:f, 32})
+    dot2 = Nx.eye({3, 3}, type: {:f, 32})
+    functions = [{:dot, &Nx.dot/2, [dot1, dot2]}]
+
+    {:module, _, _, _} =
+      EXLA.aot(VariantsAotDemo, functions, target_cpus: ["x86-64-v2", "x86-64-v3", "x86-64-v4"])
+
+    assert VariantsAotDemo.dot(dot1, dot2) == dot1
+  end
+
+  test "aot reuses instances across concurrent calls" do
+    template = Nx.template({4}, {:f, 32})
+    functions = [{:add, &Nx.add/2, [template, template]}]
+    {:module, _, _, _} = EXLA.aot(ConcurrentAotDemo, functions, num_threads: 2)
+
+    iota = Nx.iota({4}, type: {:f, 32})
+
+    results =
+      1..16
+      |> Task.async_stream(fn i ->
+        ConcurrentAotDemo.add(iota, Nx.broadcast(Nx.tensor(i, type: {:f, 32}), {4}))
+      end)
+      |> Enum.map(fn {:ok, result} -> result end)
+
+    for {result, i} <- Enum.with_index(results, 1) do
+      assert result == Nx.add(iota, i)
+    end
+  end
+
+  test "aot raises on unknown target cpus" do
+    functions = [{:exp, &Nx.exp/1, [Nx.template({3}, {:f, 32})]}]
+
+    assert_raise ArgumentError, ~r"unknown target CPU \"pentium\"", fn ->
+      EXLA.aot(UnknownCpuAotDemo, functions, target_cpus: ["pentium"])
+    end
+  end
 end
@@ -40,6 +40,21 @@ defmodule Nx.Defn.Evaluator do
     Tree.composite(res, cache, &eval(&1, vars, &2))
   end
 
+  defp eval(%Nx.Tensor{data: %Expr{op: :while, id: id, args: args}}, vars, cache) do
+    case cache do
+      %{^id => res} ->
+        {res, cache}
+
+      %{} ->
+        [initial, condition, body] = args
+        %{data: %Expr{args: [_, condition, _]}} = condition
+        %{data: %Expr{args: [_, body, _]}} = body
+        {initial, cache} = Tree.composite(initial, cache, &eval(&1, vars, &2))
+        res = while_loop(initial, condition, body)
+        {res, Map.put(cache, id, res)}
+    end
+  end
+
   defp eval(%Nx.Tensor{data: %Expr{op: :elem, args: args}}, vars, cache) do
     [tuple, i, _size] = args
     {tuple, cache} = Tree.composite(tuple, cache, &eval(&1, vars, &2))
@@ -80,6 +95,23 @@ defmodule Nx.Defn.Evaluator do
   defp eval_args({:tuple, _}, _, args), do: args
   defp eval_args(_, ans, args), do: [ans | args]
 
+  defp while_loop(state, condition, body) do
+    vars = while_vars(state)
+    {pred, _} = eval(condition, vars, %{})
+
+    if Nx.to_scalar(pred) != 0 do
+      {state, _} = Tree.composite(body, %{}, &eval(&1, vars, &2))
+      while_loop(state, condition, body)
+    else
+      state
+    end
+  end
+
+  defp while_vars(state) do
+    {_, vars} = Tree.composite(state, [], fn tensor, acc -> {tensor, [tensor | acc]} end)
+    Enum.reverse(vars)
+  end
+
   defp find_clause([{pred, clause} | clauses], last, vars, cache) do
     {pred, cache} = eval(pred, vars, cache)
     if Nx.to_scalar(pred) != 0, do: {clause, cache}, else: find_clause(clauses, last, vars, cache)
@@ -29,6 +29,10 @@ defmodule Nx.Defn.Expr do
 
     * `cond(clauses, otherwise)`
 
+    * `while(initial, condition, body)` - `condition` and `body`
+      are function nodes receiving the loop state, which has the
+      same structure as `initial`
+
     * `metadata(expr, metadata)`
 
     * `elem(tuple, pos, size)` - created automatically from
@@ -183,6 +187,82 @@ defmodule Nx.Defn.Expr do
             "got #{inspect(left)} and #{inspect(right)}"
   end
 
+  @doc """
+  Creates a `while` tensor expression.
+
+  `initial` is a tensor or a tuple of tensors. `condition` and
+  `body` are invoked once with parameters matching `initial`,
+  in the order they appear in it. `condition` must return a
+  scalar and `body` must return the same structure as `initial`.
+  """
+  def while(initial, condition, body) do
+    {initial, context} = while_initial(initial)
+    fun_context = {:while, id()}
+
+    {arg, _} =
+      Tree.composite(initial, 0, fn %T{type: type, shape: shape}, pos ->
+        {parameter(fun_context, type, shape, pos), pos + 1}
+      end)
+
+    condition = fun([arg], condition)
+
+    if condition.shape != {} do
+      raise ArgumentError,
+            "while condition must return a scalar tensor, got: #{inspect(condition.shape)}"
+    end
+
+    out = while_body(initial, body.(arg))
+    body = expr(while_out(out), fun_context, :fun, [[arg], out, body])
+    composite(initial, context, &expr(&1, context, :while, [initial, condition, body]))
+  end
+
+  defp while_initial(tuple) when is_tuple(tuple) do
+    {list, context} =
+      tuple
+      |> Tuple.to_list()
+      |> Enum.map_reduce(nil, fn initial, acc ->
+        {initial, context} = while_initial(initial)
+        {initial, acc || context}
+      end)
+
+    {List.to_tuple(list), context}
+  end
+
+  defp while_initial(initial) do
+    %{data: %{context: context}} = initial = to_expr(initial)
+    {initial, context}
+  end
+
+  defp while_body(initial, out) when is_tuple(initial) do
+    if not is_tuple(out) or tuple_size(out) != tuple_size(initial) do
+      while_mismatch!(out, initial)
+    end
+
+    initial
+    |> Tuple.to_list()
+    |> Enum.zip(Tuple.to_list(out))
+    |> Enum.map(fn {initial, out} -> while_body(initial, out) end)
+    |> List.to_tuple()
+  end
+
+  defp while_body(%{type: type, shape: shape} = initial, out) do
+    if is_tuple(out), do: while_mismatch!(out, initial)
+    out = out |> to_expr() |> Nx.as_type(type)
+    if out.shape != shape, do: while_mismatch!(out, initial)
+    out
+  end
+
+  defp while_out(tuple) when is_tuple(tuple),
+    do: %T{shape: {}, names: [], type: {:tuple, tuple_size(tuple)}}
+
+  defp while_out(tensor), do: tensor
+
+  defp while_mismatch!(out, initial) do
+    raise ArgumentError,
+          "while body must return the same shapes as the initial value, " <>
+            "got #{inspect(out)} and #{inspect(initial)}"
+  end
+
   ## Nx.Defn AST callbacks
 
   @doc false
@@ -725,6 +725,16 @@ defmodule Nx.Defn.Grad do
     """
   end
 
+  defp jvp(:while, _, _) do
+    raise ArgumentError, """
+    cannot compute gradient for while/3.
+
+    Consider using stop_grad/1 (making it equivalent \
+    to the identify function) or using custom_grad/2 (giving it \
+    a proper gradient implementation).
+    """
+  end
+
   @error [:map]
 
   defp jvp(op, _, _) when op in @error do
@@ -295,6 +295,37 @@ defmodule Nx.Defn.Kernel do
     Nx.Defn.Expr.metadata(expr, %{custom_grad: fun})
   end
 
+  @doc """
+  Runs `body` on the loop state while `condition` returns true.
+
+  `initial` is a tensor or a tuple of tensors. Both `condition`
+  and `body` receive the current state. `condition` must return
+  a scalar and `body` must return a new state with the same shapes
+  and types as `initial`. Compilers such as EXLA run the whole loop
+  on the device, without returning to Elixir between iterations.
+
+  Like other anonymous functions in `defn`, `condition` and `body`
+  cannot capture variables defined outside of them. Any tensor the
+  loop needs must be passed as part of the state.
+
+  ## Examples
+
+      defn count_to(n) do
+        {_n, acc} =
+          while({n, 0}, fn {n, acc} -> acc < n end, fn {n, acc} ->
+            {n, acc + 1}
+          end)
+
+        acc
+      end
+
+  Gradients cannot be computed through `while/3`.
+  """
+  def while(initial, condition, body)
+      when Kernel.and(is_function(condition, 1), is_function(body, 1)) do
+    Nx.Defn.Expr.while(initial, condition, body)
+  end
+
   @doc """
   Element-wise unary plus operator.
 
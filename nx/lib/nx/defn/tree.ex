@@ -39,6 +39,11 @@ defmodule Nx.Defn.Tree do
     {[clauses, last], acc}
   end
 
+  def traverse_args(%T{data: %Expr{op: :while, args: [initial, condition, body]}}, acc, fun) do
+    {initial, acc} = composite(initial, acc, fun)
+    {[initial, condition, body], acc}
+  end
+
   def traverse_args(%T{data: %Expr{op: :concatenate, args: [list | args]}}, acc, fun) do
     {list, acc} = Enum.map_reduce(list, acc, fun)
     {[list | args], acc}
@@ -160,6 +165,14 @@ defmodule Nx.Defn.Tree do
     Expr.fun(params, rewrite_type_fun(arity, fun, type_fun))
   end
 
+  defp rewrite_type(:while, [initial, condition, body], _t, type_fun) do
+    %{data: %Expr{args: [_, _, condition]}} = condition
+    %{data: %Expr{args: [_, _, body]}} = body
+    condition = rewrite_type_fun(1, condition, type_fun)
+    body = rewrite_type_fun(1, body, type_fun)
+    initial |> Expr.while(condition, body) |> while_node()
+  end
+
   defp rewrite_type(:tensor, [arg], t, type_fun) do
     type = type_fun.(t.type)
     rewrite_type_args(t, type, [Nx.as_type(arg, type)])
@@ -186,6 +199,12 @@ defmodule Nx.Defn.Tree do
     %{t | data: %{data | id: Expr.id(), args: args}, type: type}
   end
 
+  # Expr.while/3 returns the composite of the loop state,
+  # so we walk back from its first element to the loop itself.
+  defp while_node(tuple) when is_tuple(tuple), do: while_node(elem(tuple, 0))
+  defp while_node(%T{data: %Expr{op: :elem, args: [tuple, _, _]}}), do: while_node(tuple)
+  defp while_node(%T{} = t), do: t
+
   ## Nx.Defn callbacks
 
   @doc false
@@ -139,6 +139,33 @@ defmodule Nx.Defn.EvaluatorTest do
     end
   end
 
+  describe "while" do
+    defn factorial(n) do
+      {_n, _i, acc} =
+        while({n, 1, 1}, fn {n, i, _acc} -> i <= n end, fn {n, i, acc} ->
+          {n, i + 1, acc * i}
+        end)
+
+      acc
+    end
+
+    test "runs until the condition is false" do
+      assert factorial(Nx.tensor(5)) == Nx.tensor(120)
+      assert factorial(Nx.tensor(0)) == Nx.tensor(1)
+    end
+
+    defn nested_state(t) do
+      while({{t, 0}, 1.0}, fn {{_t, i}, _s} -> i < 3 end, fn {{t, i}, s} ->
+        {{t * 2, i + 1}, s / 2}
+      end)
+    end
+
+    test "with nested tuples" do
+      assert nested_state(Nx.tensor([1, 2])) ==
+               {{Nx.tensor([8, 16]), Nx.tensor(3)}, Nx.tensor(0.125)}
+    end
+  end
+
   describe "anonymous functions args" do
     defn calls_binary_fun(fun, a, b), do: fun.(a, b)
 
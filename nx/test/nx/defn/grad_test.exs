@@ -2271,6 +2271,14 @@ defmodule Nx.Defn.GradTest do
       end
     end
 
+    defn grad_while(t), do: grad(t, &while(&1, fn x -> x < 10 end, fn x -> x * 2 end))
+
+    test "raises on while" do
+      assert_raise ArgumentError, ~r"cannot compute gradient for while/3", fn ->
+        grad_while(3.0)
+      end
+    end
+
     defn grad_window_prod(t), do: grad(t, &Nx.window_product(&1, {}))
 
     test "raises on window_prod" do
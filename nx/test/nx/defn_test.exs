@@ -816,6 +816,43 @@ defmodule Nx.DefnTest do
     end
   end
 
+  describe "while" do
+    defn count_to(n) do
+      {_n, acc} = while({n, 0}, fn {n, acc} -> acc < n end, fn {n, acc} -> {n, acc + 1} end)
+      acc
+    end
+
+    test "builds a loop over the state" do
+      assert %T{data: %Expr{op: :elem, args: [loop, 1, 2]}, shape: {}, type: {:s, 64}} =
+               count_to(Nx.tensor(3))
+
+      assert %T{data: %Expr{op: :while, args: [{n, acc}, condition, body]}} = loop
+      assert %T{data: %Expr{op: :parameter}} = n
+      assert %T{data: %Expr{op: :scalar, args: [0]}} = acc
+      assert %T{data: %Expr{op: :fun, args: [[{_, _}], less, _]}} = condition
+      assert %T{data: %Expr{op: :less}} = less
+      assert %T{data: %Expr{op: :fun, args: [[{_, _}], {_, _}, _]}} = body
+    end
+
+    defn halve(t), do: while(t, fn t -> Nx.sum(t) > 1 end, fn t -> t / 2 end)
+
+    test "keeps the initial type" do
+      assert %T{data: %Expr{op: :while}, type: {:s, 64}} = halve(Nx.tensor([4, 4]))
+    end
+
+    test "raises if the body changes the shape" do
+      assert_raise ArgumentError, ~r"while body must return the same shapes", fn ->
+        defmodule InvalidWhile do
+          defn grow(t) do
+            while(t, fn t -> Nx.sum(t) < 3 end, fn t -> Nx.concatenate([t, t]) end)
+          end
+        end
+
+        InvalidWhile.grow(Nx.tensor([1]))
+      end
+    end
+  end
+
   describe "transform" do
     defn transform_inspect(a, b) do
       (Nx.tanh(a) + Nx.power(b, 3)) |> inspect_expr()
@@ -0,0 +1,41 @@
+# Compares element-wise operations run inline on a normal scheduler
+# against the same operations run on a dirty scheduler, for a range
+# of tensor sizes. The largest size where inline is still faster is
+# a good value for the :fast_path_threshold config.
+#
+#     mix run bench/fast_path.exs
+#
+# Run it with `parallel: System.schedulers_online()` added to the
+# Benchee options to also measure the impact under concurrent load.
+
+inputs =
+  for size <- [4, 64, 256, 1024, 4096, 16384, 65536], into: %{} do
+    a = Nx.iota({size}, type: {:f, 32}, backend: Torchx.Backend)
+    b = Nx.iota({size}, type: {:f, 32}, backend: Torchx.Backend)
+    {String.pad_leading(Integer.to_string(size), 5, "0"), {a, b}}
+  end
+
+op = fn {a, b} -> a |> Nx.add(b) |> Nx.multiply(b) |> Nx.exp() end
+
+Benchee.run(
+  %{
+    "inline" =>
+      {op,
+       before_scenario: fn input ->
+         Torchx.set_fast_path_threshold(1_000_000_000)
+         input
+       end},
+    "dirty" =>
+      {op,
+       before_scenario: fn input ->
+         Torchx.set_fast_path_threshold(0)
+         input
+       end}
+  },
+  inputs: inputs,
+  time: 5,
+  memory_time: 1,
+  after_scenario: fn _ ->
+    Torchx.set_fast_path_threshold(Application.get_env(:torchx, :fast_path_threshold, 1024))
+  end
+)
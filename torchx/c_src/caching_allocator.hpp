@@ -0,0 +1,172 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/core/CPUAllocator.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// CPU allocator that keeps freed blocks in power-of-two size classes,
+// so the intermediate tensors of eager loops reuse memory instead of
+// going through the system allocator for every operation.
+//
+// Each block starts with a header holding its size and size class, so
+// the deleter needs no per-block context. Blocks larger than the last
+// size class are allocated with their exact size and never cached.
+class caching_allocator final : public c10::Allocator
+{
+public:
+  static constexpr int min_class = 6;  // 64 bytes
+  static constexpr int max_class = 26; // 64 megabytes
+
+  // Keeps the data aligned as LibTorch's default CPU allocator does
+  static constexpr size_t header_size = 64;
+
+  // Sizes include the header and the rounding up to the size class
+  struct stats
+  {
+    int64_t bytes_in_use;
+    int64_t peak_bytes_in_use;
+    int64_t cached_bytes;
+    int64_t cache_hits;
+    int64_t cache_misses;
+  };
+
+  // Never destroyed, as tensors may still be freed during VM shutdown
+  static caching_allocator &instance()
+  {
+    static caching_allocator *allocator = new caching_allocator();
+    return *allocator;
+  }
+
+  c10::DataPtr allocate(size_t nbytes) const override
+  {
+    c10::Device device(c10::DeviceType::CPU);
+
+    if (nbytes == 0)
+      return {nullptr, nullptr, nullptr, device};
+
+    int size_class = class_of(nbytes + header_size);
+    size_t size = size_class < 0 ? nbytes + header_size : size_t(1) << size_class;
+    void *block = size_class < 0 ? nullptr : take_cached(size_class);
+
+    if (block == nullptr)
+    {
+      block = c10::alloc_cpu(size);
+      cache_misses++;
+    }
+    else
+    {
+      cache_hits++;
+    }
+
+    header *h = static_cast<header *>(block);
+    h->size = size;
+    h->size_class = size_class;
+
+    int64_t in_use = bytes_in_use += size;
+    int64_t peak = peak_bytes_in_use;
+    while (in_use > peak && !peak_bytes_in_use.compare_exchange_weak(peak, in_use))
+      ;
+
+    return {static_cast<char *>(block) + header_size, block, &free_block, device};
+  }
+
+  stats get_stats() const
+  {
+    return {bytes_in_use, peak_bytes_in_use, cached_bytes, cache_hits, cache_misses};
+  }
+
+  // Limits the bytes kept in the free lists. Blocks freed beyond the
+  // limit go back to the system and lowering it releases the excess,
+  // so a limit of 0 disables the cache and only keeps statistics.
+  void set_cache_limit(int64_t limit)
+  {
+    std::vector<void *> released;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      cache_limit = limit;
+
+      for (int i = max_class; i >= min_class && cached_bytes > cache_limit; i--)
+      {
+        std::vector<void *> &free_list = free_lists[i - min_class];
+
+        while (!free_list.empty() && cached_bytes > cache_limit)
+        {
+          released.push_back(free_list.back());
+          free_list.pop_back();
+          cached_bytes -= int64_t(1) << i;
+        }
+      }
+    }
+
+    for (void *block : released)
+      c10::free_cpu(block);
+  }
+
+private:
+  struct header
+  {
+    size_t size;
+    int size_class;
+  };
+
+  caching_allocator() {}
+
+  static int class_of(size_t size)
+  {
+    for (int size_class = min_class; size_class <= max_class; size_class++)
+    {
+      if ((size_t(1) << size_class) >= size)
+        return size_class;
+    }
+
+    return -1;
+  }
+
+  void *take_cached(int size_class) const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<void *> &free_list = free_lists[size_class - min_class];
+
+    if (free_list.empty())
+      return nullptr;
+
+    void *block = free_list.back();
+    free_list.pop_back();
+    cached_bytes -= int64_t(1) << size_class;
+    return block;
+  }
+
+  static void free_block(void *block)
+  {
+    caching_allocator &self = instance();
+    header *h = static_cast<header *>(block);
+    self.bytes_in_use -= h->size;
+
+    if (h->size_class >= 0)
+    {
+      std::lock_guard<std::mutex> lock(self.mutex);
+
+      if (self.cached_bytes + (int64_t)h->size <= self.cache_limit)
+      {
+        self.free_lists[h->size_class - min_class].push_back(block);
+        self.cached_bytes += h->size;
+        return;
+      }
+    }
+
+    c10::free_cpu(block);
+  }
+
+  mutable std::mutex mutex;
+  mutable std::vector<void *> free_lists[max_class - min_class + 1];
+  mutable std::atomic<int64_t> bytes_in_use{0};
+  mutable std::atomic<int64_t> peak_bytes_in_use{0};
+  mutable std::atomic<int64_t> cached_bytes{0};
+  mutable std::atomic<int64_t> cache_hits{0};
+  mutable std::atomic<int64_t> cache_misses{0};
+  int64_t cache_limit = 0;
+};
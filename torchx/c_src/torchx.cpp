@@ -1,9 +1,112 @@
 #include <torch/torch.h>
+#include <torch/csrc/jit/codegen/fuser/interface.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/common_subexpression_elimination.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/tensorexpr_fuser.h>
+#include <torch/csrc/jit/runtime/graph_executor.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
 
 #include "nx_nif_utils.hpp"
+#include "caching_allocator.hpp"
 
 ErlNifResourceType *TENSOR_TYPE;
+ErlNifResourceType *GRAPH_TYPE;
+ErlNifResourceType *EXECUTOR_TYPE;
+
+// Operations on tensors with at most this many elements run on a normal
+// scheduler, as switching to a dirty scheduler costs more than the op.
+std::atomic<int64_t> fast_path_threshold(1024);
+
+// Number of intra-op threads for each op, where 0 keeps LibTorch's default.
+// In adaptive mode, it is divided among the ops running concurrently.
+std::atomic<int> intra_op_threads(0);
+std::atomic<bool> adaptive_threads(false);
+std::atomic<int> busy_calls(0);
+int default_threads = 1;
+
+// Tensors computed asynchronously start undefined and are filled in by
+// their device worker. Until then they are kept here, with their device,
+// so readers can wait on them. Tensors whose op failed keep their error.
+struct pending_tensor
+{
+  std::shared_future<void> done;
+  std::vector<int64_t> device;
+};
+
+std::mutex pending_mutex;
+std::map<torch::Tensor *, pending_tensor> pending_tensors;
+
+bool await_tensor(torch::Tensor *tensor, std::string &error)
+{
+  std::shared_future<void> done;
+
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    auto found = pending_tensors.find(tensor);
+    if (found == pending_tensors.end())
+      return true;
+
+    done = found->second.done;
+  }
+
+  try
+  {
+    done.get();
+    return true;
+  }
+  catch (c10::Error &e)
+  {
+    error = e.msg();
+  }
+  catch (std::exception &e)
+  {
+    error = e.what();
+  }
+
+  return false;
+}
+
+bool is_pending(torch::Tensor *tensor)
+{
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  return pending_tensors.count(tensor) > 0;
+}
+
+// Queued ops by the tensors they read, guarded by pending_mutex, so ops
+// that update a tensor in place can wait for its readers. Each op removes
+// its entries when done.
+typedef std::multimap<torch::Tensor *, std::shared_future<void>> reader_map;
+reader_map queued_readers;
+std::atomic<int64_t> queued_jobs(0);
+
+// Waits for the queued ops reading the tensor, which must not see it
+// updated. Their errors are left to their readers.
+void await_readers(torch::Tensor *tensor)
+{
+  if (queued_jobs == 0)
+    return;
+
+  std::vector<std::shared_future<void>> readers;
+
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    auto range = queued_readers.equal_range(tensor);
+    for (auto reader = range.first; reader != range.second; reader++)
+      readers.push_back(reader->second);
+  }
+
+  for (std::shared_future<void> &done : readers)
+    done.wait();
+}
 
 std::map<const std::string, const torch::ScalarType> dtypes = {{"byte", torch::kByte}, {"char", torch::kChar}, {"short", torch::kShort}, {"int", torch::kInt}, {"long", torch::kLong}, {"half", torch::kHalf}, {"brain", torch::kBFloat16}, {"float", torch::kFloat}, {"double", torch::kDouble}, {"bool", torch::kBool}};
 std::map<const std::string, const int> dtype_sizes = {{"byte", 1}, {"char", 1}, {"short", 2}, {"int", 4}, {"long", 8}, {"half", 2}, {"brain", 2}, {"float", 4}, {"double", 8}};
@@ -49,10 +152,20 @@ inline std::string type2string(const torch::ScalarType type)
 
 #define OPTS(TYPE, DEV_VEC) DEVICE(DEV_VEC).dtype(TYPE)
 
+#define AWAIT_TENSOR(VAR)                          \
+  {                                                \
+    std::string await_error;                       \
+    if (!await_tensor(VAR, await_error))           \
+      return nx::nif::error(env, await_error.c_str()); \
+  }
+
 #define TENSOR_PARAM(ARGN, VAR)                                        \
   torch::Tensor *VAR;                                                  \
   if (!enif_get_resource(env, argv[ARGN], TENSOR_TYPE, (void **)&VAR)) \
-    return nx::nif::error(env, "Unable to get " #VAR " tensor param.");
+    return nx::nif::error(env, "Unable to get " #VAR " tensor param."); \
+  AWAIT_TENSOR(VAR)                                                    \
+  if (!VAR->defined())                                                 \
+    return nx::nif::error(env, "Tensor " #VAR " has been consumed by an in-place operation.");
 
 #define CATCH()                                              \
   catch (c10::Error error)                                   \
@@ -122,10 +235,14 @@ create_tensor_resource(ErlNifEnv *env, torch::Tensor tensor)
 
 NIF(delete_tensor)
 {
-  TENSOR_PARAM(0, t);
+  torch::Tensor *t;
+  if (!enif_get_resource(env, argv[0], TENSOR_TYPE, (void **)&t))
+    return nx::nif::error(env, "Unable to get t tensor param.");
 
-  t->~Tensor();
-  enif_release_resource(t);
+  // Releases the tensor data, the resource destructor runs on GC
+  std::string error;
+  await_tensor(t, error);
+  *t = torch::Tensor();
 
   return nx::nif::ok(env);
 }
@@ -149,6 +266,45 @@ NIF(from_blob)
   TENSOR(torch::clone(torch::from_blob(blob.data, shape, OPTS(type, device))));
 }
 
+void free_blob_env(void *env)
+{
+  enif_free_env((ErlNifEnv *)env);
+}
+
+NIF(from_blob_view)
+{
+  BINARY_PARAM(0, blob);
+  SHAPE_PARAM(1, shape);
+  TYPE_PARAM(2, type);
+  DEVICE_PARAM(3, device);
+
+  if (blob.size / dtype_sizes[type_atom] < elem_count(shape))
+    return nx::nif::error(env, "Binary size is too small for the requested shape");
+
+  if ((torch::DeviceType)device[0] != torch::kCPU)
+    return nx::nif::error(env, "Binary views can only be created on the CPU");
+
+  // Keep the binary alive by copying its term into an env that is owned
+  // by the tensor storage. Refc binaries are not copied, only referenced.
+  ErlNifEnv *blob_env = enif_alloc_env();
+  ERL_NIF_TERM blob_term = enif_make_copy(blob_env, argv[0]);
+  enif_inspect_binary(blob_env, blob_term, &blob);
+
+  // The env is freed once the last reference is dropped: by the storage
+  // deleter, or when leaving this function if from_blob throws before
+  // the storage takes ownership.
+  std::shared_ptr<ErlNifEnv> blob_owner(blob_env, free_blob_env);
+
+  // Heap binaries are copied into the env and sub-binaries may start at
+  // any offset, so the data may not be aligned to the element size.
+  // Misaligned data is copied instead of viewed.
+  if ((uintptr_t)blob.data % dtype_sizes[type_atom] != 0)
+    TENSOR(torch::clone(torch::from_blob(blob.data, shape, OPTS(type, device))));
+
+  TENSOR(torch::from_blob(
+      blob.data, shape, [blob_owner](void *) mutable { blob_owner.reset(); }, OPTS(type, device)));
+}
+
 NIF(to_blob)
 {
   ERL_NIF_TERM result;
@@ -161,8 +317,11 @@ NIF(to_blob)
     byte_size = limit * t->itemsize();
   }
 
+  // Views are only materialized when their memory must be read in order.
+  torch::Tensor contiguous = t->contiguous();
+
   void *result_data = (void *)enif_make_new_binary(env, byte_size, &result);
-  memcpy(result_data, t->data_ptr(), byte_size);
+  memcpy(result_data, contiguous.data_ptr(), byte_size);
 
   return result;
 }
@@ -171,7 +330,20 @@ NIF(to_blob_view)
 {
   TENSOR_PARAM(0, t);
 
-  return enif_make_resource_binary(env, t, t->data_ptr(), t->nbytes());
+  // The binary gets its own resource holding a reference to the tensor,
+  // or a contiguous copy of views, as the binary must point to contiguous
+  // memory. The extra reference keeps the memory alive if the handle is
+  // consumed and makes in-place ops leave it unchanged.
+  torch::Tensor *copy = (torch::Tensor *)enif_alloc_resource(TENSOR_TYPE, sizeof(torch::Tensor));
+  if (copy == NULL)
+    return enif_make_badarg(env);
+
+  new (copy) torch::Tensor(t->contiguous());
+
+  ERL_NIF_TERM result = enif_make_resource_binary(env, copy, copy->data_ptr(), copy->nbytes());
+  enif_release_resource(copy);
+
+  return result;
 }
 
 NIF(item)
@@ -308,7 +480,7 @@ NIF(broadcast_to)
   TENSOR_PARAM(0, t);
   SHAPE_PARAM(1, shape);
 
-  TENSOR(torch::broadcast_to(*t, shape).clone());
+  TENSOR(torch::broadcast_to(*t, shape));
 }
 
 NIF(transpose)
@@ -327,7 +499,7 @@ NIF(narrow)
   PARAM(2, int64_t, start);
   PARAM(3, int64_t, length);
 
-  TENSOR(torch::narrow(*t, dim, start, length).clone());
+  TENSOR(torch::narrow(*t, dim, start, length));
 }
 
 NIF(as_strided)
@@ -337,7 +509,11 @@ NIF(as_strided)
   LIST_PARAM(2, std::vector<int64_t>, strides);
   PARAM(3, int64_t, offset);
 
-  TENSOR(torch::as_strided(*t, size, strides, offset).clone());
+  // Strides and offset are given for the contiguous layout of the tensor,
+  // so only views which are not contiguous need to be materialized.
+  torch::Tensor base = t->contiguous();
+
+  TENSOR(torch::as_strided(base, size, strides, base.storage_offset() + offset));
 }
 
 NIF(permute)
@@ -345,9 +521,35 @@ NIF(permute)
   TENSOR_PARAM(0, t);
   LIST_PARAM(1, std::vector<int64_t>, dims);
 
-  TENSOR(t->permute(dims).contiguous());
+  TENSOR(t->permute(dims));
 }
 
+// Lengths are measured in the input, as in Nx, so the result has
+// ceil(length / stride) elements along each dimension.
+NIF(slice)
+{
+  TENSOR_PARAM(0, t);
+  LIST_PARAM(1, std::vector<int64_t>, starts);
+  LIST_PARAM(2, std::vector<int64_t>, lengths);
+  LIST_PARAM(3, std::vector<int64_t>, strides);
+
+  if (lengths.size() != starts.size() || strides.size() != starts.size())
+    return nx::nif::error(env, "Slice starts, lengths and strides must have the same size");
+
+  torch::Tensor result = *t;
+
+  try
+  {
+    for (size_t dim = 0; dim < starts.size(); dim++)
+    {
+      if (starts[dim] != 0 || lengths[dim] != result.size(dim) || strides[dim] != 1)
+        result = result.slice(dim, starts[dim], starts[dim] + lengths[dim], strides[dim]);
+    }
+  }
+  CATCH()
+
+  TENSOR(result);
+}
 
 /* Creation */
 
@@ -379,7 +581,7 @@ NIF(rand)
   TYPE_PARAM(3, type);
   DEVICE_PARAM(4, device);
 
-  TENSOR(min + torch::rand(shape, OPTS(type, device)) * (max - min));
+  TENSOR(torch::rand(shape, OPTS(type, device)).mul_(max - min).add_(min));
 }
 
 NIF(normal)
@@ -503,6 +705,63 @@ BINARY_OP(max)
 
 BINARY_OP(outer)
 
+/* In-place Binary Ops */
+
+// In-place ops consume the handle given as first argument. They update
+// its tensor only when nothing else can observe the change: no other
+// tensor or binary from to_blob_view references it or shares its
+// storage, the memory is not owned by a binary and the result has the
+// same shape and type. Otherwise a new tensor is
+// returned, so callers get the same result either way.
+bool can_update_in_place(const torch::Tensor &a, const torch::Tensor &b, bool floating_only)
+{
+  if (a.use_count() != 1 || !a.has_storage() || a.storage().use_count() != 1)
+    return false;
+
+  // Tensors created by from_blob_view point to the binary memory
+  if (a.storage().allocator() == nullptr)
+    return false;
+
+  if (floating_only && !a.is_floating_point())
+    return false;
+
+  return torch::result_type(a, b) == a.scalar_type() &&
+         at::infer_size(a.sizes(), b.sizes()) == a.sizes().vec();
+}
+
+ERL_NIF_TERM
+consume_tensor(ErlNifEnv *env, torch::Tensor *tensor)
+{
+  ERL_NIF_TERM result = create_tensor_resource(env, *tensor);
+  *tensor = torch::Tensor();
+  return result;
+}
+
+#define INPLACE_BINARY_OP(OP, NATIVE, FLOATING_ONLY)                         \
+  NIF(OP##_)                                                                 \
+  {                                                                          \
+    TENSOR_PARAM(0, a);                                                      \
+    TENSOR_PARAM(1, b);                                                      \
+    await_readers(a);                                                        \
+                                                                             \
+    try                                                                      \
+    {                                                                        \
+      if (can_update_in_place(*a, *b, FLOATING_ONLY))                        \
+        a->NATIVE##_(*b);                                                    \
+      else                                                                   \
+        *a = torch::NATIVE(*a, *b);                                          \
+                                                                             \
+      return nx::nif::ok(env, consume_tensor(env, a));                       \
+    }                                                                        \
+    CATCH()                                                                  \
+  }
+
+INPLACE_BINARY_OP(add, add, false)
+INPLACE_BINARY_OP(subtract, subtract, false)
+INPLACE_BINARY_OP(multiply, multiply, false)
+INPLACE_BINARY_OP(divide, divide, true)
+INPLACE_BINARY_OP(power, pow, false)
+
 NIF(quotient)
 {
   TENSOR_PARAM(0, a);
@@ -572,6 +831,218 @@ NIF(argmin)
   }
 }
 
+// LibTorch multiplies along one dimension at a time, so dimensions
+// are reduced from the last one to keep the remaining ones in place
+NIF(product)
+{
+  TENSOR_PARAM(0, t);
+  LIST_PARAM(1, std::vector<int64_t>, dims);
+  PARAM(2, bool, keep_dim);
+
+  if (dims.empty())
+  {
+    for (int64_t dim = 0; dim < t->dim(); dim++)
+      dims.push_back(dim);
+  }
+
+  std::sort(dims.rbegin(), dims.rend());
+  torch::Tensor result = *t;
+
+  try
+  {
+    for (int64_t dim : dims)
+      result = torch::prod(result, dim, keep_dim);
+  }
+  CATCH()
+
+  TENSOR(result);
+}
+
+NIF(reduce_max)
+{
+  TENSOR_PARAM(0, t);
+  LIST_PARAM(1, std::vector<int64_t>, dims);
+  PARAM(2, bool, keep_dim);
+
+  TENSOR(torch::amax(*t, dims, keep_dim));
+}
+
+NIF(reduce_min)
+{
+  TENSOR_PARAM(0, t);
+  LIST_PARAM(1, std::vector<int64_t>, dims);
+  PARAM(2, bool, keep_dim);
+
+  TENSOR(torch::amin(*t, dims, keep_dim));
+}
+
+NIF(cumsum)
+{
+  TENSOR_PARAM(0, t);
+  PARAM(1, int64_t, dim);
+
+  TENSOR(torch::cumsum(*t, dim, t->scalar_type()));
+}
+
+/* Windows */
+
+// Returns the value that never wins a window max (or min when
+// lowest is false), which is used to pad the windows.
+torch::Scalar window_limit(torch::ScalarType type, bool lowest)
+{
+  double infinity = std::numeric_limits<double>::infinity();
+
+  if (at::isFloatingType(type))
+    return lowest ? -infinity : infinity;
+
+  torch::Scalar limit;
+  AT_DISPATCH_INTEGRAL_TYPES(type, "window_limit", [&] {
+    limit = lowest ? std::numeric_limits<scalar_t>::lowest() : std::numeric_limits<scalar_t>::max();
+  });
+  return limit;
+}
+
+// Unfolds every dimension into its windows, so the elements of each
+// window end up in a last dimension and window reductions become
+// reductions over it. Padding is given as low and high per dimension.
+torch::Tensor
+window_view(const torch::Tensor &t, const std::vector<int64_t> &window,
+            const std::vector<int64_t> &strides, const std::vector<int64_t> &padding,
+            const std::vector<int64_t> &dilations, torch::Scalar pad_value)
+{
+  int64_t rank = t.dim();
+
+  // constant_pad_nd expects the padding of the last dimension first
+  std::vector<int64_t> pad;
+  for (int64_t dim = rank - 1; dim >= 0; dim--)
+  {
+    pad.push_back(padding[2 * dim]);
+    pad.push_back(padding[2 * dim + 1]);
+  }
+
+  torch::Tensor view = torch::constant_pad_nd(t, pad, pad_value);
+
+  for (int64_t dim = 0; dim < rank; dim++)
+  {
+    int64_t size = (window[dim] - 1) * dilations[dim] + 1;
+    view = view.unfold(dim, size, strides[dim]);
+
+    if (dilations[dim] > 1)
+      view = view.slice(-1, 0, size, dilations[dim]);
+  }
+
+  return view.flatten(rank, -1);
+}
+
+#define WINDOW_PARAMS                             \
+  TENSOR_PARAM(0, t);                             \
+  LIST_PARAM(1, std::vector<int64_t>, window);    \
+  LIST_PARAM(2, std::vector<int64_t>, strides);   \
+  LIST_PARAM(3, std::vector<int64_t>, padding);   \
+  LIST_PARAM(4, std::vector<int64_t>, dilations);
+
+#define WINDOW_VIEW(PAD_VALUE) window_view(*t, window, strides, padding, dilations, PAD_VALUE)
+
+NIF(window_sum)
+{
+  WINDOW_PARAMS
+
+  TENSOR(WINDOW_VIEW(0).sum({-1}, false, t->scalar_type()));
+}
+
+NIF(window_product)
+{
+  WINDOW_PARAMS
+
+  TENSOR(WINDOW_VIEW(1).prod(-1, false, t->scalar_type()));
+}
+
+NIF(window_max)
+{
+  WINDOW_PARAMS
+
+  TENSOR(std::get<0>(WINDOW_VIEW(window_limit(t->scalar_type(), true)).max(-1)));
+}
+
+NIF(window_min)
+{
+  WINDOW_PARAMS
+
+  TENSOR(std::get<0>(WINDOW_VIEW(window_limit(t->scalar_type(), false)).min(-1)));
+}
+
+/* Convolution */
+
+// Input and kernel come in the {batch, channels, spatial...} and
+// {filters, channels, spatial...} layouts. Padding is given as low and
+// high per spatial dimension and may be asymmetric or negative, so it
+// is applied to the input instead of given to the convolution.
+NIF(conv)
+{
+  TENSOR_PARAM(0, input);
+  TENSOR_PARAM(1, kernel);
+  LIST_PARAM(2, std::vector<int64_t>, strides);
+  LIST_PARAM(3, std::vector<int64_t>, padding);
+  LIST_PARAM(4, std::vector<int64_t>, input_dilation);
+  LIST_PARAM(5, std::vector<int64_t>, kernel_dilation);
+  PARAM(6, int64_t, groups);
+
+  torch::Tensor t = *input;
+
+  try
+  {
+    // LibTorch has no input dilation, so the zeros are interleaved here
+    for (size_t i = 0; i < input_dilation.size(); i++)
+    {
+      int64_t dim = i + 2;
+      int64_t dilation = input_dilation[i];
+
+      if (dilation > 1 && t.size(dim) > 1)
+      {
+        std::vector<int64_t> sizes = t.sizes().vec();
+        sizes[dim] = (sizes[dim] - 1) * dilation + 1;
+
+        torch::Tensor dilated = torch::zeros(sizes, t.options());
+        dilated.slice(dim, 0, sizes[dim], dilation).copy_(t);
+        t = dilated;
+      }
+    }
+
+    std::vector<int64_t> pad;
+    for (int64_t i = padding.size() / 2 - 1; i >= 0; i--)
+    {
+      pad.push_back(padding[2 * i]);
+      pad.push_back(padding[2 * i + 1]);
+    }
+
+    t = torch::constant_pad_nd(t, pad, 0);
+  }
+  CATCH()
+
+  std::vector<int64_t> zeros(strides.size(), 0);
+  TENSOR(torch::convolution(t, *kernel, {}, strides, zeros, kernel_dilation, false, zeros, groups));
+}
+
+/* Sorting */
+
+NIF(sort)
+{
+  TENSOR_PARAM(0, t);
+  PARAM(1, int64_t, dim);
+  PARAM(2, bool, descending);
+
+  TENSOR(std::get<0>(torch::sort(*t, dim, descending)));
+}
+
+NIF(argsort)
+{
+  TENSOR_PARAM(0, t);
+  PARAM(1, int64_t, dim);
+  PARAM(2, bool, descending);
+
+  TENSOR(torch::argsort(*t, dim, descending));
+}
+
 NIF(cholesky)
 {
   TENSOR_PARAM(0, t);
@@ -601,15 +1072,394 @@ NIF(qr)
   TENSOR_TUPLE(torch::qr(*t, reduced));
 }
 
+/* Programs */
+
+// A program is a list of `{op, slots}` instructions, where slots index
+// the input tensors followed by the result of each previous instruction.
+// Instructions run back to back and only the requested output slots are
+// returned as resources.
+
+typedef std::function<torch::Tensor(const std::vector<torch::Tensor> &)> program_fun;
+
+struct program_op
+{
+  size_t arity;
+  program_fun fun;
+};
+
+#define PROGRAM_BINARY_OP(OP, NATIVE)                                             \
+  {                                                                               \
+    #OP, { 2, [](const std::vector<torch::Tensor> &args) { return torch::NATIVE(args[0], args[1]); } } \
+  }
+
+#define PROGRAM_UNARY_OP(OP, NATIVE)                                         \
+  {                                                                          \
+    #OP, { 1, [](const std::vector<torch::Tensor> &args) { return torch::NATIVE(args[0]); } } \
+  }
+
+std::map<const std::string, const program_op> program_ops = {
+    PROGRAM_BINARY_OP(add, add),
+    PROGRAM_BINARY_OP(subtract, subtract),
+    PROGRAM_BINARY_OP(multiply, multiply),
+    PROGRAM_BINARY_OP(divide, divide),
+    PROGRAM_BINARY_OP(remainder, remainder),
+    PROGRAM_BINARY_OP(power, pow),
+    PROGRAM_BINARY_OP(atan2, atan2),
+    PROGRAM_BINARY_OP(min, min),
+    PROGRAM_BINARY_OP(max, max),
+    PROGRAM_BINARY_OP(bitwise_and, bitwise_and),
+    PROGRAM_BINARY_OP(bitwise_or, bitwise_or),
+    PROGRAM_BINARY_OP(bitwise_xor, bitwise_xor),
+    PROGRAM_BINARY_OP(equal, eq),
+    PROGRAM_BINARY_OP(not_equal, not_equal),
+    PROGRAM_BINARY_OP(greater, greater),
+    PROGRAM_BINARY_OP(less, less),
+    PROGRAM_BINARY_OP(greater_equal, greater_equal),
+    PROGRAM_BINARY_OP(less_equal, less_equal),
+    PROGRAM_BINARY_OP(logical_and, logical_and),
+    PROGRAM_BINARY_OP(logical_or, logical_or),
+    PROGRAM_BINARY_OP(logical_xor, logical_xor),
+    PROGRAM_UNARY_OP(abs, abs),
+    PROGRAM_UNARY_OP(ceil, ceil),
+    PROGRAM_UNARY_OP(floor, floor),
+    PROGRAM_UNARY_OP(negate, negative),
+    PROGRAM_UNARY_OP(round, round),
+    PROGRAM_UNARY_OP(sign, sign),
+    PROGRAM_UNARY_OP(exp, exp),
+    PROGRAM_UNARY_OP(log, log),
+    PROGRAM_UNARY_OP(bitwise_not, bitwise_not),
+    PROGRAM_UNARY_OP(logistic, sigmoid)};
+
+NIF(eval_program)
+{
+  LIST_PARAM(2, std::vector<int64_t>, outputs);
+
+  std::vector<torch::Tensor> slots;
+  ERL_NIF_TERM head, tail, list = argv[0];
+
+  while (enif_get_list_cell(env, list, &head, &tail))
+  {
+    torch::Tensor *t;
+    if (!enif_get_resource(env, head, TENSOR_TYPE, (void **)&t))
+      return nx::nif::error(env, "Unable to get program input tensor.");
+
+    AWAIT_TENSOR(t)
+
+    slots.push_back(*t);
+    list = tail;
+  }
+
+  try
+  {
+    list = argv[1];
+
+    while (enif_get_list_cell(env, list, &head, &tail))
+    {
+      const ERL_NIF_TERM *instruction;
+      int size;
+      std::string name;
+      std::vector<int64_t> arg_slots;
+
+      if (!enif_get_tuple(env, head, &size, &instruction) || size != 2 ||
+          !nx::nif::get_atom(env, instruction[0], name) ||
+          !nx::nif::get_list(env, instruction[1], arg_slots))
+        return nx::nif::error(env, "Unable to get program instruction.");
+
+      auto op = program_ops.find(name);
+      if (op == program_ops.end())
+        return nx::nif::error(env, ("Unknown program op " + name).c_str());
+
+      if (arg_slots.size() != op->second.arity)
+        return nx::nif::error(env, ("Wrong number of arguments for program op " + name).c_str());
+
+      std::vector<torch::Tensor> args;
+      for (int64_t slot : arg_slots)
+      {
+        if (slot < 0 || (size_t)slot >= slots.size())
+          return nx::nif::error(env, ("Invalid slot for program op " + name).c_str());
+
+        args.push_back(slots[slot]);
+      }
+
+      slots.push_back(op->second.fun(args));
+      list = tail;
+    }
+
+    std::vector<ERL_NIF_TERM> results;
+    for (int64_t slot : outputs)
+    {
+      if (slot < 0 || (size_t)slot >= slots.size())
+        return nx::nif::error(env, "Invalid program output slot.");
+
+      results.push_back(create_tensor_resource(env, slots[slot]));
+    }
+
+    return nx::nif::ok(env, enif_make_list_from_array(env, results.data(), results.size()));
+  }
+  CATCH()
+}
+
+/* TorchScript */
+
+// Graphs are built one node at a time from Elixir. Each value in the
+// graph is identified by its position in `values`, which is returned
+// to Elixir when the value is created.
+struct graph_builder
+{
+  std::shared_ptr<torch::jit::Graph> graph;
+  std::vector<torch::jit::Value *> values;
+};
+
+typedef std::shared_ptr<torch::jit::GraphExecutor> graph_executor;
+
+#define GRAPH_PARAM(ARGN, VAR)                                        \
+  graph_builder *VAR;                                                 \
+  if (!enif_get_resource(env, argv[ARGN], GRAPH_TYPE, (void **)&VAR)) \
+    return nx::nif::error(env, "Unable to get " #VAR " graph param.");
+
+#define JIT_CATCH()                                              \
+  catch (std::exception &error)                                  \
+  {                                                              \
+    std::ostringstream msg;                                      \
+    msg << error.what() << " in NIF." << __func__ << "/" << argc; \
+    return nx::nif::error(env, msg.str().c_str());               \
+  }
+
+ERL_NIF_TERM
+add_graph_value(ErlNifEnv *env, graph_builder *builder, torch::jit::Value *value)
+{
+  builder->values.push_back(value);
+  return nx::nif::ok(env, nx::nif::make(env, (int)builder->values.size() - 1));
+}
+
+// Node arguments are either `{:value, index}` or constants:
+// integers, floats, booleans, nil and lists of integers.
+int get_graph_arg(ErlNifEnv *env, ERL_NIF_TERM term, graph_builder *builder,
+                  torch::jit::NamedValue &arg)
+{
+  const ERL_NIF_TERM *tuple;
+  int size, index;
+  int64_t integer;
+  double number;
+  std::string atom;
+  std::vector<int64_t> list;
+
+  if (enif_get_tuple(env, term, &size, &tuple))
+  {
+    if (size != 2 || !enif_get_int(env, tuple[1], &index) ||
+        index < 0 || (size_t)index >= builder->values.size())
+      return 0;
+
+    arg = torch::jit::NamedValue(builder->values[index]);
+  }
+  else if (nx::nif::get(env, term, &integer))
+    arg = torch::jit::NamedValue(c10::IValue(integer));
+  else if (nx::nif::get(env, term, &number))
+    arg = torch::jit::NamedValue(c10::IValue(number));
+  else if (nx::nif::get_atom(env, term, atom))
+  {
+    if (atom == "nil")
+      arg = torch::jit::NamedValue(c10::IValue());
+    else
+      arg = torch::jit::NamedValue(c10::IValue(atom == "true"));
+  }
+  else if (nx::nif::get_list(env, term, list))
+    arg = torch::jit::NamedValue(c10::IValue(list));
+  else
+    return 0;
+
+  return 1;
+}
+
+NIF(graph_new)
+{
+  graph_builder *builder = (graph_builder *)enif_alloc_resource(GRAPH_TYPE, sizeof(graph_builder));
+  if (builder == NULL)
+    return enif_make_badarg(env);
+
+  new (builder) graph_builder{std::make_shared<torch::jit::Graph>(), {}};
+
+  ERL_NIF_TERM ret = enif_make_resource(env, builder);
+  enif_release_resource(builder);
+
+  return nx::nif::ok(env, ret);
+}
+
+NIF(graph_input)
+{
+  GRAPH_PARAM(0, builder);
+
+  torch::jit::Value *input = builder->graph->addInput();
+  input->setType(c10::TensorType::get());
+  return add_graph_value(env, builder, input);
+}
+
+NIF(graph_constant)
+{
+  GRAPH_PARAM(0, builder);
+  TENSOR_PARAM(1, t);
+
+  try
+  {
+    return add_graph_value(env, builder, builder->graph->insertConstant(*t));
+  }
+  JIT_CATCH()
+}
+
+NIF(graph_node)
+{
+  GRAPH_PARAM(0, builder);
+  ATOM_PARAM(1, kind);
+
+  std::vector<torch::jit::NamedValue> args;
+  ERL_NIF_TERM head, tail, list = argv[2];
+
+  while (enif_get_list_cell(env, list, &head, &tail))
+  {
+    torch::jit::NamedValue arg(c10::IValue{});
+    if (!get_graph_arg(env, head, builder, arg))
+      return nx::nif::error(env, "Unable to get graph node argument.");
+
+    args.push_back(arg);
+    list = tail;
+  }
+
+  try
+  {
+    // Overloads and default arguments are resolved against the op schema
+    torch::jit::Value *value = builder->graph->insert(c10::Symbol::fromQualString(kind), args);
+    return add_graph_value(env, builder, value);
+  }
+  JIT_CATCH()
+}
+
+NIF(graph_compile)
+{
+  GRAPH_PARAM(0, builder);
+  LIST_PARAM(1, std::vector<int64_t>, outputs);
+
+  // The builder is consumed by compilation, as the graph is
+  // optimized in place and owned by the executor afterwards.
+  std::shared_ptr<torch::jit::Graph> graph = builder->graph;
+  if (graph == nullptr)
+    return nx::nif::error(env, "Graph has already been compiled.");
+
+  for (int64_t index : outputs)
+  {
+    if (index < 0 || (size_t)index >= builder->values.size())
+      return nx::nif::error(env, "Invalid graph output.");
+  }
+
+  try
+  {
+    for (int64_t index : outputs)
+      graph->registerOutput(builder->values[index]);
+
+    builder->graph = nullptr;
+    builder->values.clear();
+
+    // Fusion needs complete input types, so it is left to the profiling
+    // executor, which specializes the graph on the types it has seen.
+    torch::jit::EliminateDeadCode(graph);
+    torch::jit::EliminateCommonSubexpression(graph);
+    torch::jit::ConstantPropagation(graph);
+
+    graph_executor *executor =
+        (graph_executor *)enif_alloc_resource(EXECUTOR_TYPE, sizeof(graph_executor));
+    if (executor == NULL)
+      return enif_make_badarg(env);
+
+    new (executor) graph_executor(std::make_shared<torch::jit::GraphExecutor>(graph, "torchx"));
+
+    ERL_NIF_TERM ret = enif_make_resource(env, executor);
+    enif_release_resource(executor);
+
+    return nx::nif::ok(env, ret);
+  }
+  JIT_CATCH()
+}
+
+NIF(graph_run)
+{
+  graph_executor *executor;
+  if (!enif_get_resource(env, argv[0], EXECUTOR_TYPE, (void **)&executor))
+    return nx::nif::error(env, "Unable to get executor param.");
+
+  torch::jit::Stack stack;
+  ERL_NIF_TERM head, tail, list = argv[1];
+
+  while (enif_get_list_cell(env, list, &head, &tail))
+  {
+    torch::Tensor *t;
+    if (!enif_get_resource(env, head, TENSOR_TYPE, (void **)&t))
+      return nx::nif::error(env, "Unable to get graph input tensor.");
+
+    AWAIT_TENSOR(t)
+
+    stack.push_back(*t);
+    list = tail;
+  }
+
+  try
+  {
+    (*executor)->run(stack);
+
+    std::vector<ERL_NIF_TERM> results;
+    for (c10::IValue &value : stack)
+      results.push_back(create_tensor_resource(env, value.toTensor()));
+
+    return nx::nif::ok(env, enif_make_list_from_array(env, results.data(), results.size()));
+  }
+  JIT_CATCH()
+}
+
+// Returns the graph the executor optimized for the profiled inputs,
+// once it has run enough times to be specialized.
+NIF(graph_optimized)
+{
+  graph_executor *executor;
+  if (!enif_get_resource(env, argv[0], EXECUTOR_TYPE, (void **)&executor))
+    return nx::nif::error(env, "Unable to get executor param.");
+
+  try
+  {
+    std::ostringstream graph;
+    for (auto &plan : (*executor)->getDebugState().execution_plans)
+      graph << *plan.second.graph;
+
+    return nx::nif::ok(env, nx::nif::make(env, graph.str()));
+  }
+  JIT_CATCH()
+}
+
 void free_tensor(ErlNifEnv *env, void *obj)
 {
   torch::Tensor* tensor = reinterpret_cast<torch::Tensor*>(obj);
   if (tensor != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex);
+      pending_tensors.erase(tensor);
+    }
+
     tensor->~Tensor();
     tensor = nullptr;
   }
 }
 
+void free_graph(ErlNifEnv *env, void *obj)
+{
+  graph_builder *builder = reinterpret_cast<graph_builder *>(obj);
+  if (builder != nullptr)
+    builder->~graph_builder();
+}
+
+void free_executor(ErlNifEnv *env, void *obj)
+{
+  graph_executor *executor = reinterpret_cast<graph_executor *>(obj);
+  if (executor != nullptr)
+    executor->~graph_executor();
+}
+
 static int
 open_resource_type(ErlNifEnv *env)
 {
@@ -619,6 +1469,15 @@ open_resource_type(ErlNifEnv *env)
   TENSOR_TYPE = enif_open_resource_type(env, NULL, name, free_tensor, flags, NULL);
   if (TENSOR_TYPE == NULL)
     return -1;
+
+  GRAPH_TYPE = enif_open_resource_type(env, NULL, "Graph", free_graph, flags, NULL);
+  if (GRAPH_TYPE == NULL)
+    return -1;
+
+  EXECUTOR_TYPE = enif_open_resource_type(env, NULL, "GraphExecutor", free_executor, flags, NULL);
+  if (EXECUTOR_TYPE == NULL)
+    return -1;
+
   return 0;
 }
 
@@ -638,13 +1497,568 @@ int load(ErlNifEnv *env, void **priv_data, ERL_NIF_TERM load_info)
   if (open_resource_type(env) == -1)
     return -1;
 
+  // Options are given as a map by Torchx.NIF.__on_load__/0
+  ERL_NIF_TERM value;
+  ErlNifSInt64 threshold;
+  int threads;
+  bool adaptive;
+
+  if (enif_get_map_value(env, load_info, enif_make_atom(env, "fast_path_threshold"), &value) &&
+      enif_get_int64(env, value, &threshold))
+    fast_path_threshold = threshold;
+
+  if (enif_get_map_value(env, load_info, enif_make_atom(env, "intra_op_threads"), &value) &&
+      enif_get_int(env, value, &threads))
+    intra_op_threads = threads;
+
+  if (enif_get_map_value(env, load_info, enif_make_atom(env, "adaptive_threads"), &value) &&
+      nx::nif::get(env, value, &adaptive))
+    adaptive_threads = adaptive;
+
+  if (enif_get_map_value(env, load_info, enif_make_atom(env, "interop_threads"), &value) &&
+      enif_get_int(env, value, &threads))
+  {
+    try
+    {
+      at::set_num_interop_threads(threads);
+    }
+    catch (c10::Error error)
+    {
+      return -1;
+    }
+  }
+
+  default_threads = at::get_num_threads();
+
+  // LibTorch only fuses element-wise ops of compiled graphs on GPUs by
+  // default, while Torchx graphs run on the CPU
+  torch::jit::overrideCanFuseOnCPU(true);
+  torch::jit::setTensorExprFuserEnabled(true);
+
+  // The allocator replaces LibTorch's default for all CPU tensors created
+  // from now on, while existing tensors keep the deleter they were made with
+  bool caching = true;
+  if (enif_get_map_value(env, load_info, enif_make_atom(env, "caching_allocator"), &value))
+    nx::nif::get(env, value, &caching);
+
+  if (caching)
+  {
+    ErlNifSInt64 limit;
+    if (enif_get_map_value(env, load_info, enif_make_atom(env, "cpu_cache_limit"), &value) &&
+        enif_get_int64(env, value, &limit))
+      caching_allocator::instance().set_cache_limit(limit);
+
+    c10::SetAllocator(c10::DeviceType::CPU, &caching_allocator::instance());
+  }
+
   // Silence "unused var" warnings.
   (void)(priv_data);
-  (void)(load_info);
 
   return 0;
 }
 
+/* Threading */
+
+NIF(set_num_threads)
+{
+  PARAM(0, int, threads);
+
+  intra_op_threads = threads;
+  return nx::nif::ok(env);
+}
+
+NIF(num_threads)
+{
+  int threads = intra_op_threads;
+  return nx::nif::ok(env, nx::nif::make(env, threads > 0 ? threads : default_threads));
+}
+
+NIF(set_num_interop_threads)
+{
+  PARAM(0, int, threads);
+
+  try
+  {
+    at::set_num_interop_threads(threads);
+    return nx::nif::ok(env);
+  }
+  CATCH()
+}
+
+NIF(num_interop_threads)
+{
+  return nx::nif::ok(env, nx::nif::make(env, (int)at::get_num_interop_threads()));
+}
+
+NIF(set_adaptive_threads)
+{
+  PARAM(0, bool, adaptive);
+
+  adaptive_threads = adaptive;
+  return nx::nif::ok(env);
+}
+
+struct busy_call
+{
+  busy_call() { busy_calls++; }
+  ~busy_call() { busy_calls--; }
+};
+
+// at::set_num_threads also sets MKL's process-wide count, so concurrent
+// calls would override each other's limit for BLAS ops. Instead, only the
+// counts that OpenMP and MKL keep per calling thread are set, on each
+// dirty scheduler thread before it runs an op. The symbols are resolved
+// from the OpenMP and MKL runtimes LibTorch was built with, if any.
+extern "C" void omp_set_num_threads(int) __attribute__((weak));
+extern "C" int mkl_set_num_threads_local(int) __attribute__((weak));
+
+void set_local_threads(int threads)
+{
+  thread_local int current_threads = 0;
+  if (threads == current_threads)
+    return;
+
+  if (omp_set_num_threads != nullptr)
+    omp_set_num_threads(threads);
+  else
+    at::set_num_threads(threads);
+
+  if (mkl_set_num_threads_local != nullptr)
+    mkl_set_num_threads_local(threads);
+
+  current_threads = threads;
+}
+
+ERL_NIF_TERM
+parallel_call(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[],
+              ERL_NIF_TERM (*fun)(ErlNifEnv *, int, const ERL_NIF_TERM[]))
+{
+  int threads = intra_op_threads;
+  bool adaptive = adaptive_threads;
+
+  if (threads <= 0 && !adaptive)
+  {
+    set_local_threads(default_threads);
+    return fun(env, argc, argv);
+  }
+
+  busy_call busy;
+
+  if (threads <= 0)
+    threads = default_threads;
+
+  if (adaptive)
+    threads = std::max(1, threads / std::max(1, busy_calls.load()));
+
+  set_local_threads(threads);
+  return fun(env, argc, argv);
+}
+
+template <ERL_NIF_TERM (*FUN)(ErlNifEnv *, int, const ERL_NIF_TERM[])>
+ERL_NIF_TERM threaded(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[])
+{
+  return parallel_call(env, argc, argv, FUN);
+}
+
+/* Memory */
+
+NIF(memory_stats)
+{
+  caching_allocator::stats stats = caching_allocator::instance().get_stats();
+
+  ERL_NIF_TERM keys[] = {
+      enif_make_atom(env, "bytes_in_use"),
+      enif_make_atom(env, "peak_bytes_in_use"),
+      enif_make_atom(env, "cached_bytes"),
+      enif_make_atom(env, "cache_hits"),
+      enif_make_atom(env, "cache_misses")};
+
+  ERL_NIF_TERM values[] = {
+      nx::nif::make(env, (long)stats.bytes_in_use),
+      nx::nif::make(env, (long)stats.peak_bytes_in_use),
+      nx::nif::make(env, (long)stats.cached_bytes),
+      nx::nif::make(env, (long)stats.cache_hits),
+      nx::nif::make(env, (long)stats.cache_misses)};
+
+  ERL_NIF_TERM map;
+  enif_make_map_from_arrays(env, keys, values, 5, &map);
+  return nx::nif::ok(env, map);
+}
+
+NIF(set_cpu_cache_limit)
+{
+  PARAM(0, int64_t, limit);
+
+  caching_allocator::instance().set_cache_limit(limit);
+  return nx::nif::ok(env);
+}
+
+/* Scheduling */
+
+NIF(set_fast_path_threshold)
+{
+  PARAM(0, int64_t, threshold);
+
+  fast_path_threshold = threshold;
+  return nx::nif::ok(env);
+}
+
+// Returns the number of elements of the broadcasted tensor arguments,
+// which is the work done by element-wise ops, or -1 if there are none.
+int64_t work_size(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[])
+{
+  std::vector<int64_t> dims;
+  bool found = false;
+
+  for (int i = 0; i < argc; i++)
+  {
+    torch::Tensor *t;
+    if (!enif_get_resource(env, argv[i], TENSOR_TYPE, (void **)&t))
+      continue;
+
+    // Pending tensors are awaited on a dirty scheduler
+    if (is_pending(t))
+      return -1;
+
+    // Consumed and deleted tensors are reported by the op itself
+    if (!t->defined())
+      return -1;
+
+    found = true;
+    c10::IntArrayRef sizes = t->sizes();
+
+    if (sizes.size() > dims.size())
+      dims.insert(dims.begin(), sizes.size() - dims.size(), 1);
+
+    size_t offset = dims.size() - sizes.size();
+    for (size_t j = 0; j < sizes.size(); j++)
+      dims[offset + j] = std::max(dims[offset + j], sizes[j]);
+  }
+
+  if (!found)
+    return -1;
+
+  return std::accumulate(dims.begin(), dims.end(), (int64_t)1, std::multiplies<int64_t>());
+}
+
+// Runs small ops inline and accounts for them in the process timeslice,
+// with an op at the threshold counting as 10% of it. Larger ops are
+// rescheduled on a dirty CPU scheduler.
+ERL_NIF_TERM
+sized_call(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[], const char *name,
+           ERL_NIF_TERM (*fun)(ErlNifEnv *, int, const ERL_NIF_TERM[]),
+           ERL_NIF_TERM (*dirty_fun)(ErlNifEnv *, int, const ERL_NIF_TERM[]))
+{
+  int64_t threshold = fast_path_threshold;
+  int64_t size = work_size(env, argc, argv);
+
+  if (size < 0 || size > threshold)
+    return enif_schedule_nif(env, name, ERL_NIF_DIRTY_JOB_CPU_BOUND, dirty_fun, argc, argv);
+
+  ERL_NIF_TERM result = fun(env, argc, argv);
+  int percent = threshold > 0 ? (int)(1 + size * 10 / threshold) : 1;
+  enif_consume_timeslice(env, std::min(percent, 100));
+
+  return result;
+}
+
+#define SIZED_NIF(NAME) \
+  NIF(NAME##_sized) { return sized_call(env, argc, argv, #NAME, NAME, threaded<NAME>); }
+
+// Metadata and scalar reads run on a normal scheduler, which must not
+// block, so calls given a pending tensor are rescheduled on a dirty CPU
+// scheduler where they wait for it.
+ERL_NIF_TERM
+awaiting_call(ErlNifEnv *env, int argc, const ERL_NIF_TERM argv[], const char *name,
+              ERL_NIF_TERM (*fun)(ErlNifEnv *, int, const ERL_NIF_TERM[]))
+{
+  for (int i = 0; i < argc; i++)
+  {
+    torch::Tensor *t;
+    if (enif_get_resource(env, argv[i], TENSOR_TYPE, (void **)&t) && is_pending(t))
+      return enif_schedule_nif(env, name, ERL_NIF_DIRTY_JOB_CPU_BOUND, fun, argc, argv);
+  }
+
+  return fun(env, argc, argv);
+}
+
+#define AWAITING_NIF(NAME) \
+  NIF(NAME##_awaiting) { return awaiting_call(env, argc, argv, #NAME, NAME); }
+
+AWAITING_NIF(item)
+AWAITING_NIF(scalar_type)
+AWAITING_NIF(shape)
+AWAITING_NIF(names)
+AWAITING_NIF(strides)
+AWAITING_NIF(device_of)
+AWAITING_NIF(nbytes)
+AWAITING_NIF(to_blob_view)
+AWAITING_NIF(graph_constant)
+
+SIZED_NIF(reshape)
+SIZED_NIF(to_type)
+SIZED_NIF(squeeze)
+SIZED_NIF(broadcast_to)
+SIZED_NIF(transpose)
+SIZED_NIF(permute)
+SIZED_NIF(narrow)
+SIZED_NIF(as_strided)
+SIZED_NIF(slice)
+
+SIZED_NIF(add)
+SIZED_NIF(subtract)
+SIZED_NIF(divide)
+SIZED_NIF(remainder)
+SIZED_NIF(quotient)
+SIZED_NIF(multiply)
+SIZED_NIF(power)
+SIZED_NIF(atan2)
+SIZED_NIF(min)
+SIZED_NIF(max)
+
+SIZED_NIF(bitwise_and)
+SIZED_NIF(bitwise_or)
+SIZED_NIF(bitwise_xor)
+SIZED_NIF(left_shift)
+SIZED_NIF(right_shift)
+
+SIZED_NIF(equal)
+SIZED_NIF(not_equal)
+SIZED_NIF(greater)
+SIZED_NIF(less)
+SIZED_NIF(greater_equal)
+SIZED_NIF(less_equal)
+
+SIZED_NIF(logical_and)
+SIZED_NIF(logical_or)
+SIZED_NIF(logical_xor)
+
+SIZED_NIF(abs)
+SIZED_NIF(ceil)
+SIZED_NIF(floor)
+SIZED_NIF(negate)
+SIZED_NIF(round)
+SIZED_NIF(sign)
+SIZED_NIF(exp)
+SIZED_NIF(log)
+SIZED_NIF(bitwise_not)
+SIZED_NIF(logistic)
+
+/* Asynchronous execution */
+
+// Each device runs its asynchronous ops one after the other on its own
+// thread. As ops are queued in the order they were called, their inputs
+// on the same device are always computed first.
+struct device_worker
+{
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<std::function<void()>> jobs;
+
+  device_worker() { std::thread(&device_worker::run, this).detach(); }
+
+  void push(std::function<void()> job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+
+    ready.notify_one();
+  }
+
+  void run()
+  {
+    while (true)
+    {
+      std::function<void()> job;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return !jobs.empty(); });
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+
+      job();
+    }
+  }
+};
+
+// Workers are never destroyed, as they run for as long as the VM
+device_worker &worker_for(const std::vector<int64_t> &device)
+{
+  static std::mutex mutex;
+  static std::map<std::vector<int64_t>, device_worker *> workers;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  device_worker *&worker = workers[device];
+
+  if (worker == nullptr)
+    worker = new device_worker();
+
+  return *worker;
+}
+
+typedef ERL_NIF_TERM (*nif_fun)(ErlNifEnv *, int, const ERL_NIF_TERM[]);
+
+// Ops that may run asynchronously, by name and arity
+std::map<std::pair<std::string, int>, nif_fun> async_ops;
+void register_async_ops();
+
+// Runs the op with the arguments copied to the job environment and moves
+// its tensor into the pending resource, which is released afterwards
+// along with the op's entries in queued_readers.
+void run_async(ErlNifEnv *env, nif_fun fun, std::vector<ERL_NIF_TERM> args,
+               torch::Tensor *result, std::shared_ptr<std::promise<void>> promise,
+               std::vector<reader_map::iterator> readers)
+{
+  try
+  {
+    ERL_NIF_TERM term = parallel_call(env, args.size(), args.data(), fun);
+    const ERL_NIF_TERM *tuple;
+    int arity;
+    torch::Tensor *tensor;
+
+    if (!enif_get_tuple(env, term, &arity, &tuple) || arity != 2)
+      throw std::runtime_error("Asynchronous operation did not return a tensor.");
+
+    if (!enif_is_identical(tuple[0], enif_make_atom(env, "ok")))
+    {
+      char message[1024] = "Asynchronous operation failed.";
+      enif_get_string(env, tuple[1], message, sizeof(message), ERL_NIF_LATIN1);
+      throw std::runtime_error(message);
+    }
+
+    if (!enif_get_resource(env, tuple[1], TENSOR_TYPE, (void **)&tensor))
+      throw std::runtime_error("Asynchronous operation did not return a tensor.");
+
+    *result = *tensor;
+    promise->set_value();
+  }
+  catch (...)
+  {
+    promise->set_exception(std::current_exception());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+
+    if (result->defined())
+      pending_tensors.erase(result);
+
+    for (reader_map::iterator reader : readers)
+      queued_readers.erase(reader);
+  }
+
+  queued_jobs--;
+
+  enif_release_resource(result);
+  enif_free_env(env);
+}
+
+// Returns the device of the first tensor argument, which may be pending
+bool async_device(ErlNifEnv *env, const std::vector<ERL_NIF_TERM> &args,
+                  std::vector<int64_t> &device)
+{
+  for (ERL_NIF_TERM arg : args)
+  {
+    torch::Tensor *t;
+    if (!enif_get_resource(env, arg, TENSOR_TYPE, (void **)&t))
+      continue;
+
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    auto found = pending_tensors.find(t);
+
+    if (found != pending_tensors.end())
+      device = found->second.device;
+    else if (t->defined())
+      device = {(int64_t)t->device().type(), (int64_t)t->device().index()};
+    else
+      return false;
+
+    return true;
+  }
+
+  return false;
+}
+
+// Queues the op on the worker of its device and returns a pending tensor
+// right away. The device is given for ops without tensor arguments.
+NIF(async_call)
+{
+  ATOM_PARAM(0, name);
+  DEVICE_PARAM(2, device);
+
+  static std::once_flag registered;
+  std::call_once(registered, register_async_ops);
+
+  unsigned length;
+  if (!enif_get_list_length(env, argv[1], &length))
+    return nx::nif::error(env, "Unable to get args list param.");
+
+  auto found = async_ops.find({name, (int)length});
+  if (found == async_ops.end())
+  {
+    std::ostringstream msg;
+    msg << "Unable to run " << name << "/" << length << " asynchronously.";
+    return nx::nif::error(env, msg.str().c_str());
+  }
+
+  // The job environment also keeps the argument tensors alive
+  ErlNifEnv *job_env = enif_alloc_env();
+  std::vector<ERL_NIF_TERM> args;
+  ERL_NIF_TERM head, tail, list = enif_make_copy(job_env, argv[1]);
+
+  while (enif_get_list_cell(job_env, list, &head, &tail))
+  {
+    args.push_back(head);
+    list = tail;
+  }
+
+  async_device(job_env, args, device);
+
+  torch::Tensor *result = (torch::Tensor *)enif_alloc_resource(TENSOR_TYPE, sizeof(torch::Tensor));
+  if (result == NULL)
+  {
+    enif_free_env(job_env);
+    return enif_make_badarg(env);
+  }
+
+  new (result) torch::Tensor();
+
+  auto promise = std::make_shared<std::promise<void>>();
+  std::shared_future<void> done = promise->get_future().share();
+  std::vector<reader_map::iterator> readers;
+
+  queued_jobs++;
+
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    pending_tensors[result] = {done, device};
+
+    for (ERL_NIF_TERM arg : args)
+    {
+      torch::Tensor *t;
+      if (enif_get_resource(job_env, arg, TENSOR_TYPE, (void **)&t))
+        readers.push_back(queued_readers.emplace(t, done));
+    }
+  }
+
+  nif_fun fun = found->second;
+  worker_for(device).push([=]() { run_async(job_env, fun, args, result, promise, readers); });
+
+  // The job holds the resource reference from enif_alloc_resource
+  return nx::nif::ok(env, enif_make_resource(env, result));
+}
+
+NIF(await)
+{
+  TENSOR_PARAM(0, t);
+
+  return nx::nif::ok(env);
+}
+
 #define F(NAME, ARITY)    \
   {                       \
 #NAME, ARITY, NAME, 0 \
@@ -652,11 +2066,25 @@ int load(ErlNifEnv *env, void **priv_data, ERL_NIF_TERM load_info)
 
 #define DF(NAME, ARITY)                                  \
   {                                                      \
-      #NAME, ARITY, NAME, ERL_NIF_DIRTY_JOB_CPU_BOUND},  \
+      #NAME, ARITY, threaded<NAME>, ERL_NIF_DIRTY_JOB_CPU_BOUND},  \
   {                                                      \
 #NAME "_io", ARITY, NAME, ERL_NIF_DIRTY_JOB_IO_BOUND \
   }
 
+// Like F, except calls given a pending tensor move to a dirty scheduler
+#define AF(NAME, ARITY)          \
+  {                              \
+#NAME, ARITY, NAME##_awaiting, 0 \
+  }
+
+// Like DF, except the CPU variant runs inline for small tensors
+#define SDF(NAME, ARITY)                       \
+  {                                            \
+      #NAME, ARITY, NAME##_sized, 0},          \
+  {                                            \
+#NAME "_io", ARITY, NAME, ERL_NIF_DIRTY_JOB_IO_BOUND \
+  }
+
 static ErlNifFunc nif_functions[] = {
     DF(randint, 5),
     DF(rand, 5),
@@ -669,68 +2097,93 @@ static ErlNifFunc nif_functions[] = {
     DF(full, 4),
 
     DF(from_blob, 4),
+    DF(from_blob_view, 4),
     DF(to_blob, 1),
     DF(to_blob, 2),
     DF(delete_tensor, 1),
-    DF(reshape, 2),
+    SDF(reshape, 2),
     DF(split, 2),
-    DF(to_type, 2),
+    SDF(to_type, 2),
     DF(to_device, 2),
-    DF(squeeze, 2),
-    DF(squeeze, 1),
-    DF(broadcast_to, 2),
-    DF(transpose, 3),
-    DF(permute, 2),
-    DF(narrow, 4),
-    DF(as_strided, 4),
-
-    DF(add, 2),
-    DF(subtract, 2),
-    DF(divide, 2),
-    DF(remainder, 2),
-    DF(quotient, 2),
-    DF(multiply, 2),
-    DF(power, 2),
-    DF(atan2, 2),
-    DF(min, 2),
-    DF(max, 2),
-
-    DF(bitwise_and, 2),
-    DF(bitwise_or, 2),
-    DF(bitwise_xor, 2),
-    DF(left_shift, 2),
-    DF(right_shift, 2),
-
-    DF(equal, 2),
-    DF(not_equal, 2),
-    DF(greater, 2),
-    DF(less, 2),
-    DF(greater_equal, 2),
-    DF(less_equal, 2),
-
-    DF(logical_and, 2),
-    DF(logical_or, 2),
-    DF(logical_xor, 2),
+    SDF(squeeze, 2),
+    SDF(squeeze, 1),
+    SDF(broadcast_to, 2),
+    SDF(transpose, 3),
+    SDF(permute, 2),
+    SDF(narrow, 4),
+    SDF(as_strided, 4),
+    SDF(slice, 4),
+
+    SDF(add, 2),
+    SDF(subtract, 2),
+    SDF(divide, 2),
+    SDF(remainder, 2),
+    SDF(quotient, 2),
+
+    DF(add_, 2),
+    DF(subtract_, 2),
+    DF(multiply_, 2),
+    DF(divide_, 2),
+    DF(power_, 2),
+
+    SDF(multiply, 2),
+    SDF(power, 2),
+    SDF(atan2, 2),
+    SDF(min, 2),
+    SDF(max, 2),
+
+    SDF(bitwise_and, 2),
+    SDF(bitwise_or, 2),
+    SDF(bitwise_xor, 2),
+    SDF(left_shift, 2),
+    SDF(right_shift, 2),
+
+    SDF(equal, 2),
+    SDF(not_equal, 2),
+    SDF(greater, 2),
+    SDF(less, 2),
+    SDF(greater_equal, 2),
+    SDF(less_equal, 2),
+
+    SDF(logical_and, 2),
+    SDF(logical_or, 2),
+    SDF(logical_xor, 2),
 
     DF(outer, 2),
     DF(sum, 3),
     DF(argmax, 3),
     DF(argmin, 3),
-
-    DF(abs, 1),
-    DF(ceil, 1),
-    DF(floor, 1),
-    DF(negate, 1),
-    DF(round, 1),
-    DF(sign, 1),
-    DF(exp, 1),
-    DF(log, 1),
-    DF(bitwise_not, 1),
-    DF(logistic, 1),
+    DF(product, 3),
+    DF(reduce_max, 3),
+    DF(reduce_min, 3),
+    DF(cumsum, 2),
+
+    DF(window_sum, 5),
+    DF(window_product, 5),
+    DF(window_max, 5),
+    DF(window_min, 5),
+    DF(conv, 7),
+    DF(sort, 3),
+    DF(argsort, 3),
+
+    SDF(abs, 1),
+    SDF(ceil, 1),
+    SDF(floor, 1),
+    SDF(negate, 1),
+    SDF(round, 1),
+    SDF(sign, 1),
+    SDF(exp, 1),
+    SDF(log, 1),
+    SDF(bitwise_not, 1),
+    SDF(logistic, 1),
 
     DF(tensordot, 4),
     DF(matmul, 2),
 
+    DF(eval_program, 3),
+    DF(graph_compile, 2),
+    DF(graph_run, 2),
+
     DF(cholesky, 1),
     DF(cholesky, 2),
     DF(qr, 1),
@@ -739,14 +2192,45 @@ static ErlNifFunc nif_functions[] = {
     DF(cuda_is_available, 0),
     DF(cuda_device_count, 0),
 
-    F(item, 1),
-    F(scalar_type, 1),
-    F(shape, 1),
-    F(names, 1),
-    F(strides, 1),
-    F(device_of, 1),
-    F(nbytes, 1),
-    F(to_blob_view, 1),
+    F(set_fast_path_threshold, 1),
+    F(set_num_threads, 1),
+    F(num_threads, 0),
+    F(set_num_interop_threads, 1),
+    F(num_interop_threads, 0),
+    F(set_adaptive_threads, 1),
+    F(memory_stats, 0),
+    F(set_cpu_cache_limit, 1),
+    AF(item, 1),
+    AF(scalar_type, 1),
+    AF(shape, 1),
+    AF(names, 1),
+    AF(strides, 1),
+    AF(device_of, 1),
+    AF(nbytes, 1),
+    AF(to_blob_view, 1),
+    F(graph_new, 0),
+    F(graph_input, 1),
+    AF(graph_constant, 2),
+    F(graph_node, 3),
+    F(graph_optimized, 1),
+    F(async_call, 3),
+    DF(await, 1),
 };
 
+// Every dirty op can run asynchronously, using the variant without
+// scheduling or threading of its own, as the worker takes care of it.
+void register_async_ops()
+{
+  std::string suffix = "_io";
+
+  for (const ErlNifFunc &f : nif_functions)
+  {
+    std::string name = f.name;
+
+    if (f.flags == ERL_NIF_DIRTY_JOB_IO_BOUND && name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+      async_ops[{name.substr(0, name.size() - suffix.size()), (int)f.arity}] = f.fptr;
+  }
+}
+
 ERL_NIF_INIT(Elixir.Torchx.NIF, nif_functions, load, NULL, upgrade, NULL)
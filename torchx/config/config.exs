@@ -2,4 +2,6 @@ import Config
 
 config :torchx,
   add_backend_on_inspect: config_env() != :test,
-  check_shape_and_type: config_env() == :test
+  check_shape_and_type: config_env() == :test,
+  zero_copy_from_binary: true,
+  fast_path_threshold: 1024
@@ -1,4 +1,60 @@
 defmodule Torchx do
+  @moduledoc """
+  Bindings to LibTorch and a compiler for numerical definitions.
+
+  `Torchx.Backend` evaluates tensor operations eagerly. `Torchx` can
+  also be used as a `Nx.Defn` compiler, which converts the whole
+  numerical definition into a TorchScript graph:
+
+      @defn_compiler Torchx
+      defn softmax(t), do: Nx.exp(t) / Nx.sum(Nx.exp(t))
+
+  The graph is compiled once per combination of argument shapes and
+  types and runs in a single NIF call. LibTorch's graph executor
+  profiles the first runs and then fuses chains of element-wise
+  operations, specialized on the argument types. Only CPU execution and
+  element-wise, shape, dot product and sum operations are supported by
+  the compiler for now.
+
+  ## Configuration
+
+  Threading is configured in the `:torchx` application environment,
+  which is read when the NIFs are loaded:
+
+      config :torchx,
+        intra_op_threads: 4,
+        interop_threads: 2,
+        adaptive_threads: true,
+        thread_affinity: :close
+
+    * `:intra_op_threads` - threads used by each operation.
+      See `set_num_threads/1`
+
+    * `:interop_threads` - threads used to run independent operations
+      in parallel. See `set_num_interop_threads/1`
+
+    * `:adaptive_threads` - divides the intra-op threads among the
+      operations running concurrently. See `set_adaptive_threads/1`
+
+    * `:thread_affinity` - binds OpenMP threads to cores, either
+      `:close` or `:spread`. It sets `OMP_PROC_BIND` and `OMP_PLACES`,
+      unless they are already set
+
+    * `:fast_path_threshold` - see `set_fast_path_threshold/1`
+
+  CPU tensors are allocated by a caching allocator, which keeps freed
+  memory in power-of-two size classes for reuse by later tensors:
+
+    * `:caching_allocator` - set it to `false` to keep LibTorch's
+      default allocator. Defaults to `true`
+
+    * `:cpu_cache_limit` - maximum bytes kept for reuse. See
+      `set_cpu_cache_limit/1`
+
+  """
+
+  @behaviour Nx.Defn.Compiler
+
   alias Torchx.NIF
 
   alias Torchx.Backend, as: TB
@@ -33,6 +89,100 @@ defmodule Torchx do
   def device_count(:cuda), do: NIF.cuda_device_count()
   def device_count(_), do: raise("Only CUDA devices can be counted for now.")
 
+  @doc """
+  Sets the maximum number of elements for an operation to run
+  on a normal scheduler.
+
+  Dirty schedulers are meant for long running work and switching
+  to them costs more than element-wise operations on small tensors.
+  CPU operations whose (broadcasted) inputs have at most `threshold`
+  elements therefore run inline. Larger operations run on a dirty
+  CPU scheduler. Set it to `0` to always use dirty schedulers.
+
+  The initial value comes from the `:fast_path_threshold` config of
+  the `:torchx` application and defaults to 1024. See
+  `bench/fast_path.exs` to measure a threshold for your machine.
+  """
+  def set_fast_path_threshold(threshold) when is_integer(threshold) and threshold >= 0 do
+    NIF.set_fast_path_threshold(threshold)
+  end
+
+  @doc """
+  Sets the number of threads used by each operation (intra-op parallelism).
+
+  LibTorch starts as many threads as there are cores by default, which
+  oversubscribes the machine when several dirty schedulers run operations
+  at once. The initial value comes from the `:intra_op_threads` config.
+  """
+  def set_num_threads(threads) when is_integer(threads) and threads > 0 do
+    NIF.set_num_threads(threads)
+  end
+
+  @doc """
+  Returns the number of threads used by each operation.
+  """
+  def num_threads, do: NIF.num_threads() |> unwrap!()
+
+  @doc """
+  Sets the number of threads used to run independent operations in
+  parallel (inter-op parallelism), such as inside TorchScript graphs.
+
+  LibTorch only allows it to be set once, before any inter-op work
+  starts, so prefer the `:interop_threads` config.
+  """
+  def set_num_interop_threads(threads) when is_integer(threads) and threads > 0 do
+    NIF.set_num_interop_threads(threads) |> unwrap!()
+  end
+
+  @doc """
+  Returns the number of inter-op threads.
+  """
+  def num_interop_threads, do: NIF.num_interop_threads() |> unwrap!()
+
+  @doc """
+  Enables or disables adaptive intra-op parallelism.
+
+  When enabled, the intra-op threads are divided among the Torchx
+  operations running at the same time, so each one of them gets at
+  least one thread and busy dirty schedulers do not compete for the
+  same cores. The initial value comes from the `:adaptive_threads`
+  config.
+
+  Thread counts are applied per scheduler thread, to both OpenMP and
+  MKL, so BLAS operations such as dot products honor them too. This
+  requires LibTorch to be built with OpenMP, as the official builds are.
+  """
+  def set_adaptive_threads(adaptive) when is_boolean(adaptive) do
+    NIF.set_adaptive_threads(adaptive)
+  end
+
+  @doc """
+  Returns statistics of the CPU caching allocator as a map:
+
+    * `:bytes_in_use` - bytes held by live tensors
+    * `:peak_bytes_in_use` - maximum of `:bytes_in_use` so far
+    * `:cached_bytes` - bytes kept for reuse
+    * `:cache_hits` - allocations served from the cache
+    * `:cache_misses` - allocations served by the system
+
+  Sizes are counted per block, so they include the rounding up to
+  the size class. All values are zero when the `:caching_allocator`
+  config is `false`.
+  """
+  def memory_stats, do: NIF.memory_stats() |> unwrap!()
+
+  @doc """
+  Sets the maximum number of bytes the CPU caching allocator keeps
+  for reuse, releasing cached memory above the new limit.
+
+  A limit of `0` releases all cached memory and turns off caching.
+  The initial value comes from the `:cpu_cache_limit` config and
+  defaults to 256MB.
+  """
+  def set_cpu_cache_limit(limit) when is_integer(limit) and limit >= 0 do
+    NIF.set_cpu_cache_limit(limit)
+  end
+
   # LibTorch API bindings
 
   ## Creation
@@ -54,6 +204,139 @@ defmodule Torchx do
     |> wrap_with_device(device)
   end
 
+  @doc """
+  Returns the cumulative sum of `tensor` along `axis`, with the type
+  of `tensor`.
+  """
+  def cumsum({device, ref}, axis) when is_integer(axis) do
+    NIF.call(:cumsum, device, [ref, axis])
+    |> wrap_with_device(device)
+  end
+
+  @doc """
+  Returns the indices that sort `tensor` along `axis`.
+
+  ## Options
+
+    * `:descending` - sorts from the largest value. Defaults to `false`
+
+  """
+  def argsort({device, ref}, axis, opts \\ []) when is_integer(axis) do
+    descending = Keyword.get(opts, :descending, false)
+
+    NIF.call(:argsort, device, [ref, axis, descending])
+    |> wrap_with_device(device)
+  end
+
+  ## In-place operations
+
+  for op <- [:add, :subtract, :multiply, :divide, :power] do
+    name = :"#{op}_"
+
+    @doc """
+    Computes `#{op}` of `left` and `right`, reusing the memory of `left`.
+
+    `left` is consumed: it must not be used afterwards, even if the
+    operation could not be done in place. It is updated in place only
+    when no other tensor shares its memory and the result has the same
+    shape and type as `left`. Otherwise a new tensor is returned.
+
+    This avoids allocating a new tensor per step in loops such as
+    parameter updates:
+
+        w = Torchx.#{name}(w, Torchx.multiply(lr, g))
+
+    """
+    def unquote(name)(left, right) do
+      {device, [left_ref, right_ref]} = to_refs([left, right])
+
+      NIF.call(unquote(name), device, [left_ref, right_ref])
+      |> wrap_with_device(device)
+    end
+  end
+
+  ## Asynchronous execution
+
+  @doc """
+  Runs `fun` with asynchronous execution enabled in the calling process.
+
+  Torchx operations called by `fun`, including `Nx` functions given
+  `Torchx.Backend` tensors, are queued on a native worker thread of
+  their device and return a tensor right away, which becomes valid
+  when the operation completes. Each device runs its operations in
+  the order they were called, so a whole computation, such as a
+  forward pass, can be dispatched while the previous operations
+  still run:
+
+      {device, ref} =
+        Torchx.async(fn ->
+          w = Torchx.arange(0, 1_000_000, 1, type: :float)
+          Torchx.add(w, Torchx.cumsum(w, 0))
+        end)
+
+  In-place operations, such as `add_/2`, always run synchronously.
+  They first wait for the queued operations that read the tensor they
+  update, while operations on other tensors keep running.
+
+  Operations that read a tensor, such as `Torchx.NIF.to_blob/1` or
+  any `Nx` function given a tensor backed by it, wait until it is
+  computed. Errors are returned when the tensor is read. Reads that
+  usually run on a normal scheduler, such as shapes or `item`, move to
+  a dirty scheduler while the tensor is pending. Use `await/1` to wait
+  for a tensor explicitly.
+  """
+  def async(fun) when is_function(fun, 0) do
+    previous = Process.put(:torchx_async, true)
+
+    try do
+      fun.()
+    after
+      Process.put(:torchx_async, previous || false)
+    end
+  end
+
+  @doc """
+  Waits until an asynchronously computed `tensor` is valid and returns it.
+
+  It raises if the operation computing it failed.
+  """
+  def await({device, ref}) do
+    NIF.await(ref) |> unwrap!()
+    {device, ref}
+  end
+
+  @doc """
+  Evaluates a program of element-wise operations in a single call.
+
+  `inputs` are tensors on the same device. `program` is a list of
+  `{op, slots}` instructions, where `op` is a binary or unary
+  element-wise operation, such as `:add` or `:exp`, and `slots`
+  are indexes into the inputs followed by the result of each
+  previous instruction. Only the tensors in the `outputs` slots
+  are returned, intermediate results are never exposed.
+
+      a = Torchx.arange(0, 4)
+      b = Torchx.arange(4, 8)
+
+      # exp(a + b) * b
+      program = [{:add, [0, 1]}, {:exp, [2]}, {:multiply, [3, 1]}]
+      [result] = Torchx.eval_program([a, b], program, [4])
+
+  """
+  def eval_program(inputs, program, outputs) do
+    {device, refs} = to_refs(inputs)
+
+    NIF.call(:eval_program, device, [refs, program, outputs])
+    |> unwrap!()
+    |> Enum.map(&{device, &1})
+  end
+
+  @impl true
+  defdelegate __jit__(key, vars, fun, opts), to: Torchx.Defn
+
+  @impl true
+  defdelegate __async__(key, vars, fun, opts), to: Torchx.Defn
+
   ## Utils
 
   @doc false
@@ -106,6 +389,7 @@ defmodule Torchx do
 
   def torch_device(opts) when is_list(opts), do: opts |> TB.device_option() |> torch_device()
 
+  defp unwrap!(:ok), do: :ok
   defp unwrap!({:ok, result}), do: result
   defp unwrap!({:error, error}), do: raise("Torchx: " <> List.to_string(error))
 
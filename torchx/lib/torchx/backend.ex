@@ -101,33 +101,32 @@ defmodule Torchx.Backend do
 
   @impl true
   def scalar(%T{shape: {}, type: type} = out, scalar, backend_options) do
-    NIF.scalar_tensor(scalar, torch_type(type), torch_device(backend_options))
-    |> from_ref(out)
+    call(:scalar_tensor, backend_options, [scalar, torch_type(type)]) |> from_ref(out)
   end
 
   def scalar(%T{shape: shape, type: type} = out, scalar, backend_options) do
-    NIF.full(shape, scalar, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:full, backend_options, [shape, scalar, torch_type(type)]) |> from_ref(out)
   end
 
   @impl true
   def eye(%T{shape: {n, n}, type: type} = out, backend_options) do
-    NIF.eye(n, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:eye, backend_options, [n, torch_type(type)]) |> from_ref(out)
   end
 
   @impl true
   def iota(out, axis \\ nil, backend_options)
 
   def iota(%T{shape: {}, type: type} = out, nil, backend_options) do
-    NIF.scalar_tensor(0.0, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:scalar_tensor, backend_options, [0.0, torch_type(type)]) |> from_ref(out)
   end
 
   def iota(%T{shape: shape, type: type} = out, nil, backend_options) do
-    NIF.arange(0, Nx.size(shape), 1, torch_type(type), torch_device(backend_options), shape)
+    call(:arange, backend_options, [0, Nx.size(shape), 1, torch_type(type)], [shape])
     |> from_ref(out)
   end
 
   def iota(%T{shape: {n}, type: type} = out, 0, backend_options) do
-    NIF.arange(0, n, 1, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:arange, backend_options, [0, n, 1, torch_type(type)]) |> from_ref(out)
   end
 
   def iota(%T{shape: shape, type: type} = out, axis, backend_options) do
@@ -135,14 +134,14 @@ defmodule Torchx.Backend do
     dim = elem(shape, axis)
 
     # build the iota in one dimension
-    aten = NIF.arange(0, dim, 1, torch_type(type), torch_device(backend_options)) |> unwrap!()
+    aten = call(:arange, backend_options, [0, dim, 1, torch_type(type)]) |> unwrap!()
 
     # reshape the tensor above to be have shape where everything is 1, except for dim
     reshape = Tuple.duplicate(1, Nx.rank(shape)) |> put_elem(axis, dim)
-    aten = NIF.reshape(aten, reshape) |> unwrap!()
+    aten = call(:reshape, [aten, reshape]) |> unwrap!()
 
     # Now broadcast the tensor using the original shape
-    NIF.broadcast_to(aten, shape) |> from_ref(out)
+    call(:broadcast_to, [aten, shape]) |> from_ref(out)
   end
 
   @impl true
@@ -150,21 +149,21 @@ defmodule Torchx.Backend do
       when s in [:u, :s] do
     min = to_scalar(min)
     max = to_scalar(max)
-    NIF.randint(min, max, shape, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:randint, backend_options, [min, max, shape, torch_type(type)]) |> from_ref(out)
   end
 
   def random_uniform(%T{type: {f, _} = type, shape: shape} = out, min, max, backend_options)
       when f in [:f, :bf] do
     min = to_scalar(min)
     max = to_scalar(max)
-    NIF.rand(min, max, shape, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:rand, backend_options, [min, max, shape, torch_type(type)]) |> from_ref(out)
   end
 
   @impl true
   def random_normal(%T{type: type, shape: shape} = out, mu, sigma, backend_options) do
     mu = to_scalar(mu)
     sigma = to_scalar(sigma)
-    NIF.normal(mu, sigma, shape, torch_type(type), torch_device(backend_options)) |> from_ref(out)
+    call(:normal, backend_options, [mu, sigma, shape, torch_type(type)]) |> from_ref(out)
   end
 
   ## Transfer
@@ -195,7 +194,7 @@ defmodule Torchx.Backend do
     device = device_option(opts)
 
     if device != device(tensor) do
-      NIF.to_device(to_ref(tensor), torch_device(device)) |> from_ref(tensor)
+      call(:to_device, [to_ref(tensor), torch_device(device)]) |> from_ref(tensor)
     else
       tensor
     end
@@ -207,34 +206,40 @@ defmodule Torchx.Backend do
 
   @impl true
   def from_binary(%T{type: type, shape: shape} = out, binary, backend_options) do
-    NIF.from_blob(
-      binary,
-      shape,
-      torch_type(type),
-      torch_device(backend_options)
-    )
+    device = device_option(backend_options)
+
+    from_blob(device)
+    |> apply([binary, shape, torch_type(type), torch_device(device)])
     |> from_ref(out)
   end
 
+  # CPU tensors share memory with the binary, which is kept alive by
+  # the tensor. Tensors on other devices always copy.
+  if Application.get_env(:torchx, :zero_copy_from_binary, true) do
+    defp from_blob(:cpu), do: &NIF.from_blob_view/4
+  end
+
+  defp from_blob(_device), do: &NIF.from_blob/4
+
   ## Shape
 
   @impl true
   def reshape(out, %T{} = t, shape),
-    do: NIF.reshape(to_ref(t), shape) |> from_ref(out)
+    do: call(:reshape, [to_ref(t), shape]) |> from_ref(out)
 
   @impl true
   def as_type(%T{type: type} = out, %T{} = t),
-    do: NIF.to_type(to_ref(t), torch_type(type)) |> from_ref(out)
+    do: call(:to_type, [to_ref(t), torch_type(type)]) |> from_ref(out)
 
   @impl true
   def squeeze(out, %T{} = t, _axes) do
-    NIF.squeeze(to_ref(t)) |> from_ref(out)
+    call(:squeeze, [to_ref(t)]) |> from_ref(out)
   end
 
   # TODO: Handle axes properly
   @impl true
   def broadcast(out, %T{} = t, shape, axes) do
-    NIF.broadcast_to(maybe_reshape(t, shape, axes) |> to_ref(), shape) |> from_ref(out)
+    call(:broadcast_to, [maybe_reshape(t, shape, axes) |> to_ref(), shape]) |> from_ref(out)
   end
 
   defp maybe_reshape(%T{shape: {n}} = t, {n, _}, [0]), do: Nx.reshape(t, {n, 1})
@@ -242,61 +247,46 @@ defmodule Torchx.Backend do
 
   @impl true
   def transpose(out, %T{} = t, axes) do
-    NIF.permute(to_ref(t), axes) |> from_ref(out)
+    call(:permute, [to_ref(t), axes]) |> from_ref(out)
   end
 
   @impl true
-  def slice(%T{shape: shape} = out, %T{} = t, start_indices, lengths, strides) do
-    t
-    |> to_ref()
-    |> narrow(start_indices, lengths, 0, shape)
-    |> stride(shape, lengths, strides)
-    |> to_tensor(out)
+  def slice(out, %T{} = t, start_indices, lengths, strides) do
+    call(:slice, [to_ref(t), start_indices, lengths, strides]) |> from_ref(out)
   end
 
-  defp narrow(ref, [start | starts], [length | lengths], axis, shape) do
-    dim = elem(shape, axis)
-
-    # Nothing to narrow
-    if start == 0 and length == dim do
-      narrow(ref, starts, lengths, axis + 1, shape)
-    else
-      ref
-      |> NIF.narrow(axis, start, length)
-      |> unwrap!()
-      |> narrow(starts, lengths, axis + 1, shape)
-    end
-  end
+  ## Aggregators
 
-  defp narrow(ref, [], [], _axis, _shape), do: ref
+  @impl true
+  def sum(%T{type: out_type} = out, %T{} = t, opts) do
+    check_type!(out_type, "sum")
 
-  defp stride(ref, shape, lengths, strides) do
-    if Enum.all?(strides, &(&1 == 1)) do
-      ref
-    else
-      ref
-      |> NIF.as_strided(shape, steps_to_strides(lengths, strides), 0)
-      |> unwrap!()
-    end
-  end
+    axes = opts[:axes] || []
+    keep_axes = opts[:keep_axes] || false
 
-  def steps_to_strides(shape, steps) do
-    for {dim, step} <- Enum.zip(shape, steps) |> Enum.reverse(), reduce: {1, []} do
-      {offset, strides} -> {offset * dim, [offset * step | strides]}
-    end
-    |> elem(1)
+    call(:sum, [to_ref(t), axes, keep_axes]) |> from_ref(out)
   end
 
-  ## Aggregators
-
   @impl true
-  def sum(%T{type: out_type} = out, %T{} = t, opts) do
-    check_type!(out_type)
+  def product(%T{type: out_type} = out, %T{type: type} = t, opts) do
+    check_type!(out_type, "product")
 
     axes = opts[:axes] || []
     keep_axes = opts[:keep_axes] || false
 
-    NIF.sum(to_ref(t), axes, keep_axes) |> from_ref(out)
+    # LibTorch returns longs for integer products, but not for scalars
+    ref = t |> to_ref() |> from_typed_ref(type, out_type)
+    call(:product, [ref, axes, keep_axes]) |> from_ref(out)
+  end
+
+  for op <- [:reduce_max, :reduce_min] do
+    @impl true
+    def unquote(op)(%T{} = out, %T{} = t, opts) do
+      axes = opts[:axes] || []
+      keep_axes = opts[:keep_axes] || false
+
+      call(unquote(op), [to_ref(t), axes, keep_axes]) |> from_ref(out)
+    end
   end
 
   @impl true
@@ -306,7 +296,7 @@ defmodule Torchx.Backend do
     axis = opts[:axis] || -1
     keep_axes = opts[:keep_axes] || false
 
-    NIF.argmax(to_ref(t), axis, keep_axes) |> from_ref(out)
+    call(:argmax, [to_ref(t), axis, keep_axes]) |> from_ref(out)
   end
 
   @impl true
@@ -316,7 +306,7 @@ defmodule Torchx.Backend do
     axis = opts[:axis] || -1
     keep_axes = opts[:keep_axes] || false
 
-    NIF.argmin(to_ref(t), axis, keep_axes) |> from_ref(out)
+    call(:argmin, [to_ref(t), axis, keep_axes]) |> from_ref(out)
   end
 
   defp unsupported_option!(opts, key, acceptable_default) do
@@ -332,9 +322,76 @@ defmodule Torchx.Backend do
     "#{inspect(module)}.#{func}/#{arity - 1}"
   end
 
-  defp check_type!(type),
-    do:
-      torch_type(type, "(explicitly cast the input tensor to a signed integer before taking sum)")
+  defp check_type!(type, op) do
+    hint = "(explicitly cast the input tensor to a signed integer before taking #{op})"
+    torch_type(type, hint)
+  end
+
+  ## Windows
+
+  for op <- [:window_sum, :window_product, :window_max, :window_min] do
+    @impl true
+    def unquote(op)(out, %T{} = t, window_dimensions, opts) do
+      padding = Enum.flat_map(opts[:padding], &Tuple.to_list/1)
+
+      call(unquote(op), [
+        to_ref(t),
+        Tuple.to_list(window_dimensions),
+        opts[:strides],
+        padding,
+        opts[:window_dilations]
+      ])
+      |> from_ref(out)
+    end
+  end
+
+  @impl true
+  def conv(%T{type: type} = out, %T{} = t, %T{} = kernel, opts) do
+    unsupported_option!(opts, :batch_group_size, 1)
+
+    input_ref = t |> to_ref() |> from_typed_ref(t.type, type)
+    input_ref = call(:permute, [input_ref, opts[:input_permutation]]) |> unwrap!()
+
+    kernel_ref = kernel |> to_ref() |> from_typed_ref(kernel.type, type)
+    kernel_ref = call(:permute, [kernel_ref, opts[:kernel_permutation]]) |> unwrap!()
+
+    # The convolution returns {batch, filters, spatial...}, which is
+    # moved to the requested output layout
+    output_axes =
+      opts[:output_permutation]
+      |> Enum.with_index()
+      |> Enum.sort()
+      |> Enum.map(&elem(&1, 1))
+
+    conv_ref =
+      call(:conv, [
+        input_ref,
+        kernel_ref,
+        opts[:strides],
+        Enum.flat_map(opts[:padding], &Tuple.to_list/1),
+        opts[:input_dilation],
+        opts[:kernel_dilation],
+        opts[:feature_group_size]
+      ])
+      |> unwrap!()
+
+    call(:permute, [conv_ref, output_axes]) |> from_ref(out)
+  end
+
+  ## Sorting
+
+  @impl true
+  def sort(out, %T{} = t, opts) do
+    # Nx's :desc comparator sorts in ascending order
+    descending =
+      case opts[:comparator] do
+        :desc -> false
+        :asc -> true
+        _ -> raise "comparator functions are not supported in #{caller(2)}"
+      end
+
+    call(:sort, [to_ref(t), opts[:axis], descending]) |> from_ref(out)
+  end
 
   ## Ops
 
@@ -350,7 +407,7 @@ defmodule Torchx.Backend do
     def unquote(op)(out, l, r) do
       {left, right} = maybe_cast_u8(l, r)
 
-      NIF.unquote(op)(to_ref(left), to_ref(right)) |> from_ref(out)
+      call(unquote(op), [to_ref(left), to_ref(right)]) |> from_ref(out)
     end
   end
 
@@ -373,9 +430,9 @@ defmodule Torchx.Backend do
       %T{type: {_, size_right}} = right
 
       if size_left >= size_right do
-        NIF.unquote(op)(to_ref(left), to_ref(right))
+        call(unquote(op), [to_ref(left), to_ref(right)])
       else
-        NIF.unquote(op)(to_ref(right), to_ref(left))
+        call(unquote(op), [to_ref(right), to_ref(left)])
       end
       |> from_ref(out)
     end
@@ -391,7 +448,7 @@ defmodule Torchx.Backend do
     if {op, 1} in NIF.__info__(:functions) do
       @impl true
       def unquote(op)(out, tensor) do
-        NIF.unquote(op)(to_ref(tensor)) |> from_ref(out)
+        call(unquote(op), [to_ref(tensor)]) |> from_ref(out)
       end
     end
   end
@@ -404,23 +461,23 @@ defmodule Torchx.Backend do
         %T{type: right_type, data: %TB{ref: right_ref}},
         right_axes
       ) do
-    NIF.tensordot(
+    call(:tensordot, [
       from_typed_ref(left_ref, left_type, out_type),
       from_typed_ref(right_ref, right_type, out_type),
       left_axes,
       right_axes
-    )
+    ])
     |> from_ref(out)
   end
 
   defp from_typed_ref(ref, expected_type, expected_type), do: ref
 
   defp from_typed_ref(ref, _ref_type, expected_type),
-    do: NIF.to_type(ref, torch_type(expected_type)) |> unwrap!()
+    do: call(:to_type, [ref, torch_type(expected_type)]) |> unwrap!()
 
   @impl true
   def cholesky(%T{} = out, %T{} = t) do
-    NIF.cholesky(to_ref(t)) |> from_ref(out)
+    call(:cholesky, [to_ref(t)]) |> from_ref(out)
   end
 
   @impl true
@@ -460,6 +517,15 @@ defmodule Torchx.Backend do
 
   ## Helpers
 
+  # Ops run asynchronously inside Torchx.async/1, see Torchx.NIF.call/2
+  defp call(func, args), do: NIF.call(func, args)
+
+  # Creation ops take the device after their other arguments
+  defp call(func, backend_options, args, rest \\ []) do
+    device = device_option(backend_options)
+    NIF.call(func, device, args ++ [torch_device(device) | rest])
+  end
+
   defp unwrap!({:ok, result}), do: result
   defp unwrap!({:error, error}), do: raise("Torchx: " <> List.to_string(error))
 
@@ -0,0 +1,308 @@
+defmodule Torchx.Defn do
+  @moduledoc false
+
+  alias Nx.Defn.{Expr, Tree}
+  alias Nx.Tensor, as: T
+  alias Torchx.Backend, as: TB
+  alias Torchx.NIF
+
+  @scalar_types %{
+    byte: 0,
+    char: 1,
+    short: 2,
+    int: 3,
+    long: 4,
+    half: 5,
+    float: 6,
+    double: 7,
+    bool: 11,
+    brain: 15
+  }
+
+  @binary_ops %{
+    add: :"aten::add",
+    subtract: :"aten::sub",
+    multiply: :"aten::mul",
+    divide: :"aten::div",
+    power: :"aten::pow",
+    remainder: :"aten::fmod",
+    atan2: :"aten::atan2",
+    min: :"aten::minimum",
+    max: :"aten::maximum",
+    bitwise_and: :"aten::bitwise_and",
+    bitwise_or: :"aten::bitwise_or",
+    bitwise_xor: :"aten::bitwise_xor",
+    outer: :"aten::outer"
+  }
+
+  @predicate_ops %{
+    equal: :"aten::eq",
+    not_equal: :"aten::ne",
+    greater: :"aten::gt",
+    less: :"aten::lt",
+    greater_equal: :"aten::ge",
+    less_equal: :"aten::le",
+    logical_and: :"aten::logical_and",
+    logical_or: :"aten::logical_or",
+    logical_xor: :"aten::logical_xor"
+  }
+
+  @unary_ops %{
+    exp: :"aten::exp",
+    expm1: :"aten::expm1",
+    log: :"aten::log",
+    log1p: :"aten::log1p",
+    logistic: :"aten::sigmoid",
+    cos: :"aten::cos",
+    sin: :"aten::sin",
+    tan: :"aten::tan",
+    cosh: :"aten::cosh",
+    sinh: :"aten::sinh",
+    tanh: :"aten::tanh",
+    acos: :"aten::acos",
+    asin: :"aten::asin",
+    atan: :"aten::atan",
+    acosh: :"aten::acosh",
+    asinh: :"aten::asinh",
+    atanh: :"aten::atanh",
+    sqrt: :"aten::sqrt",
+    rsqrt: :"aten::rsqrt",
+    erf: :"aten::erf",
+    erfc: :"aten::erfc",
+    erf_inv: :"aten::erfinv",
+    abs: :"aten::abs",
+    ceil: :"aten::ceil",
+    floor: :"aten::floor",
+    negate: :"aten::neg",
+    round: :"aten::round",
+    sign: :"aten::sign",
+    bitwise_not: :"aten::bitwise_not"
+  }
+
+  @doc false
+  def __async__(key, vars, fun, opts) do
+    Nx.Defn.Async.async(fn -> __jit__(key, vars, fun, opts) end)
+  end
+
+  @doc false
+  def __jit__(key, vars, fun, _opts) do
+    vars = Enum.map(vars, &to_torchx/1)
+    cache_key = {__MODULE__, key, Enum.map(vars, &{&1.type, &1.shape, &1.names})}
+
+    {executor, holes} =
+      case :persistent_term.get(cache_key, nil) do
+        nil ->
+          compiled = compile(fun.(vars), vars)
+          :persistent_term.put(cache_key, compiled)
+          compiled
+
+        compiled ->
+          compiled
+      end
+
+    refs = for %T{data: %TB{ref: ref}} <- vars, do: ref
+
+    results =
+      NIF.call(:graph_run, :cpu, [executor, refs])
+      |> unwrap!()
+
+    {result, []} =
+      Tree.composite(holes, results, fn hole, [ref | refs] ->
+        {%{hole | data: %TB{ref: ref}}, refs}
+      end)
+
+    result
+  end
+
+  defp to_torchx(%T{data: %TB{}} = t), do: t
+  defp to_torchx(%T{} = t), do: Nx.backend_transfer(t, TB)
+
+  ## Compilation
+
+  defp compile(expr, vars) do
+    graph = NIF.graph_new() |> unwrap!()
+    params = Enum.map(vars, fn _ -> NIF.graph_input(graph) |> to_value!() end)
+    state = %{graph: graph, params: params}
+
+    {holes, {outputs, _cache}} =
+      Tree.composite(expr, {[], %{}}, fn t, {outputs, cache} ->
+        {value, cache} = recur(t, state, cache)
+        {%{t | data: nil}, {[value | outputs], cache}}
+      end)
+
+    outputs = for {:value, index} <- Enum.reverse(outputs), do: index
+
+    executor =
+      NIF.call(:graph_compile, :cpu, [graph, outputs])
+      |> unwrap!()
+
+    {executor, holes}
+  end
+
+  defp recur(%T{data: %Expr{id: id, op: op}} = t, state, cache) do
+    case cache do
+      %{^id => value} ->
+        {value, cache}
+
+      %{} ->
+        {value, cache} = to_value(op, t, state, cache)
+        {value, Map.put(cache, id, value)}
+    end
+  end
+
+  defp to_value(:parameter, %T{data: %Expr{args: [i]}}, state, cache) do
+    {Enum.fetch!(state.params, i), cache}
+  end
+
+  defp to_value(:tensor, %T{data: %Expr{args: [tensor]}}, state, cache) do
+    {constant(to_torchx(tensor), state), cache}
+  end
+
+  defp to_value(:scalar, %T{data: %Expr{args: [number]}} = t, state, cache) do
+    %T{type: type, shape: shape} = t
+    tensor = number |> Nx.tensor(type: type, backend: TB) |> Nx.broadcast(shape)
+    {constant(tensor, state), cache}
+  end
+
+  defp to_value(:metadata, %T{data: %Expr{args: [expr, _metadata]}}, state, cache) do
+    recur(expr, state, cache)
+  end
+
+  defp to_value(:as_type, %T{data: %Expr{args: [arg]}, type: type}, state, cache) do
+    {value, cache} = recur(arg, state, cache)
+    {cast(value, arg.type, type, state), cache}
+  end
+
+  defp to_value(op, %T{data: %Expr{args: [arg | _]}, shape: shape}, state, cache)
+       when op in [:reshape, :squeeze] do
+    {value, cache} = recur(arg, state, cache)
+    {node(state, :"aten::reshape", [value, Tuple.to_list(shape)]), cache}
+  end
+
+  defp to_value(:transpose, %T{data: %Expr{args: [arg, axes]}}, state, cache) do
+    {value, cache} = recur(arg, state, cache)
+    {node(state, :"aten::permute", [value, axes]), cache}
+  end
+
+  defp to_value(:broadcast, %T{data: %Expr{args: [arg, shape, axes]}}, state, cache) do
+    {value, cache} = recur(arg, state, cache)
+
+    # Move the existing dimensions to their axes before expanding
+    dims = Tuple.to_list(arg.shape)
+    positions = Enum.zip(axes, dims) |> Map.new()
+    aligned = for axis <- Nx.axes(shape), do: Map.get(positions, axis, 1)
+
+    value =
+      if aligned == dims,
+        do: value,
+        else: node(state, :"aten::reshape", [value, aligned])
+
+    {node(state, :"aten::expand", [value, Tuple.to_list(shape)]), cache}
+  end
+
+  defp to_value(:slice, %T{data: %Expr{args: args}}, state, cache) do
+    [arg, start_indices, lengths, strides] = args
+    {value, cache} = recur(arg, state, cache)
+
+    value =
+      [start_indices, lengths, strides, Tuple.to_list(arg.shape)]
+      |> Enum.zip()
+      |> Enum.with_index()
+      |> Enum.reduce(value, fn
+        {{0, dim, 1, dim}, _axis}, value ->
+          value
+
+        {{start, length, stride, _dim}, axis}, value ->
+          node(state, :"aten::slice", [value, axis, start, start + length, stride])
+      end)
+
+    {value, cache}
+  end
+
+  defp to_value(:dot, %T{data: %Expr{args: args}, type: type}, state, cache) do
+    [left, axes1, right, axes2] = args
+    {left_value, cache} = recur(left, state, cache)
+    {right_value, cache} = recur(right, state, cache)
+    left_value = cast(left_value, left.type, type, state)
+    right_value = cast(right_value, right.type, type, state)
+    {node(state, :"aten::tensordot", [left_value, right_value, axes1, axes2]), cache}
+  end
+
+  defp to_value(:sum, %T{data: %Expr{args: [arg, opts]}, type: type}, state, cache) do
+    {value, cache} = recur(arg, state, cache)
+    axes = opts[:axes] || Nx.axes(arg.shape)
+    keep_axes = opts[:keep_axes] || false
+
+    # LibTorch sums integers as longs, so we cast the result back
+    value = cast(value, arg.type, type, state)
+    value = node(state, :"aten::sum", [value, axes, keep_axes])
+    {to_type(value, type, state), cache}
+  end
+
+  defp to_value(:select, %T{data: %Expr{args: args}, type: type}, state, cache) do
+    [pred, on_true, on_false] = args
+    {pred_value, cache} = recur(pred, state, cache)
+    {true_value, cache} = recur(on_true, state, cache)
+    {false_value, cache} = recur(on_false, state, cache)
+
+    pred_value = node(state, :"aten::to", [pred_value, @scalar_types.bool, false, false])
+    true_value = cast(true_value, on_true.type, type, state)
+    false_value = cast(false_value, on_false.type, type, state)
+    {node(state, :"aten::where", [pred_value, true_value, false_value]), cache}
+  end
+
+  defp to_value(op, %T{data: %Expr{args: [left, right]}, type: type}, state, cache)
+       when is_map_key(@binary_ops, op) do
+    {left_value, cache} = recur(left, state, cache)
+    {right_value, cache} = recur(right, state, cache)
+    left_value = cast(left_value, left.type, type, state)
+    right_value = cast(right_value, right.type, type, state)
+    {node(state, Map.fetch!(@binary_ops, op), [left_value, right_value]), cache}
+  end
+
+  defp to_value(op, %T{data: %Expr{args: [left, right]}, type: type}, state, cache)
+       when is_map_key(@predicate_ops, op) do
+    {left_value, cache} = recur(left, state, cache)
+    {right_value, cache} = recur(right, state, cache)
+
+    # Predicates return booleans in LibTorch
+    value = node(state, Map.fetch!(@predicate_ops, op), [left_value, right_value])
+    {to_type(value, type, state), cache}
+  end
+
+  defp to_value(op, %T{data: %Expr{args: [arg]}, type: type}, state, cache)
+       when is_map_key(@unary_ops, op) do
+    {value, cache} = recur(arg, state, cache)
+    value = cast(value, arg.type, type, state)
+    {node(state, Map.fetch!(@unary_ops, op), [value]), cache}
+  end
+
+  defp to_value(op, _expr, _state, _cache) do
+    raise ArgumentError, "Torchx does not support #{inspect(op)} inside defn"
+  end
+
+  ## Helpers
+
+  # Graph values are tagged, so they can be told apart from
+  # integer constants when given as node arguments.
+  defp to_value!(maybe_index), do: {:value, unwrap!(maybe_index)}
+
+  defp constant(%T{data: %TB{ref: ref}}, state) do
+    NIF.graph_constant(state.graph, ref) |> to_value!()
+  end
+
+  defp node(state, kind, args) do
+    NIF.graph_node(state.graph, kind, args) |> to_value!()
+  end
+
+  defp cast(value, type, type, _state), do: value
+  defp cast(value, _from, to, state), do: to_type(value, to, state)
+
+  defp to_type(value, type, state) do
+    scalar_type = Map.fetch!(@scalar_types, TB.torch_type(type))
+    node(state, :"aten::to", [value, scalar_type, false, false])
+  end
+
+  defp unwrap!({:ok, result}), do: result
+  defp unwrap!({:error, error}), do: raise("Torchx: " <> List.to_string(error))
+end
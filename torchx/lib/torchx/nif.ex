@@ -23,9 +23,29 @@ defmodule Torchx.NIF do
   @moduledoc false
   @on_load :__on_load__
 
+  @cache_limit 256 * 1024 * 1024
+
   def __on_load__ do
+    # OpenMP reads its affinity settings when LibTorch is loaded
+    if affinity = Application.get_env(:torchx, :thread_affinity) do
+      put_new_env("OMP_PROC_BIND", Atom.to_string(affinity))
+      put_new_env("OMP_PLACES", "cores")
+    end
+
+    load_info =
+      [:intra_op_threads, :interop_threads, :adaptive_threads, :caching_allocator]
+      |> Enum.map(&{&1, Application.get_env(:torchx, &1)})
+      |> Enum.reject(&(elem(&1, 1) == nil))
+      |> Map.new()
+      |> Map.put(:fast_path_threshold, Application.get_env(:torchx, :fast_path_threshold, 1024))
+      |> Map.put(:cpu_cache_limit, Application.get_env(:torchx, :cpu_cache_limit, @cache_limit))
+
     path = :filename.join(:code.priv_dir(:torchx), 'torchx')
-    :erlang.load_nif(path, 0)
+    :erlang.load_nif(path, load_info)
+  end
+
+  defp put_new_env(name, value) do
+    if System.get_env(name) == nil, do: System.put_env(name, value)
   end
 
   dnif randint(min, max, shape, type, device)
@@ -42,6 +62,7 @@ defmodule Torchx.NIF do
   dnif to_type(tensor, type)
   dnif to_device(tensor, device)
   dnif from_blob(blob, shape, type, device)
+  dnif from_blob_view(blob, shape, type, device)
   dnif to_blob(tensor)
   dnif to_blob(tensor, limit)
 
@@ -54,10 +75,23 @@ defmodule Torchx.NIF do
   dnif split(tensor, split_size)
   dnif narrow(tensor, dim, start, length)
   dnif as_strided(tensor, size, strides, offset)
+  dnif slice(tensor, starts, lengths, strides)
 
   dnif sum(tensor, axes, keep_axes)
   dnif argmax(tensor, axe, keep_axes)
   dnif argmin(tensor, axe, keep_axes)
+  dnif product(tensor, axes, keep_axes)
+  dnif reduce_max(tensor, axes, keep_axes)
+  dnif reduce_min(tensor, axes, keep_axes)
+  dnif cumsum(tensor, axis)
+
+  dnif window_sum(tensor, window, strides, padding, dilations)
+  dnif window_product(tensor, window, strides, padding, dilations)
+  dnif window_max(tensor, window, strides, padding, dilations)
+  dnif window_min(tensor, window, strides, padding, dilations)
+  dnif conv(tensor, kernel, strides, padding, input_dilation, kernel_dilation, groups)
+  dnif sort(tensor, axis, descending)
+  dnif argsort(tensor, axis, descending)
 
   dnif add(tensorA, tensorB)
   dnif subtract(tensorA, tensorB)
@@ -89,6 +123,12 @@ defmodule Torchx.NIF do
 
   dnif outer(tensorA, tensorB)
 
+  dnif add_(tensorA, tensorB)
+  dnif subtract_(tensorA, tensorB)
+  dnif multiply_(tensorA, tensorB)
+  dnif divide_(tensorA, tensorB)
+  dnif power_(tensorA, tensorB)
+
   @unary_ops [:abs, :bitwise_not, :ceil, :floor, :negate, :round, :sign, :count_leading_zeros] ++
                [:population_count, :exp, :log, :logistic]
 
@@ -100,6 +140,10 @@ defmodule Torchx.NIF do
   dnif tensordot(tensorA, tensorB, axesA, axesB)
   dnif matmul(tensorA, tensorB)
 
+  dnif eval_program(tensors, program, outputs)
+  dnif graph_compile(graph, outputs)
+  dnif graph_run(executor, tensors)
+
   # Transformations
   dnif cholesky(tensor)
   dnif cholesky(tensor, upper)
@@ -109,6 +153,14 @@ defmodule Torchx.NIF do
   dnif cuda_is_available()
   dnif cuda_device_count()
 
+  def set_fast_path_threshold(_threshold), do: :erlang.nif_error(:undef)
+  def set_num_threads(_threads), do: :erlang.nif_error(:undef)
+  def num_threads(), do: :erlang.nif_error(:undef)
+  def set_num_interop_threads(_threads), do: :erlang.nif_error(:undef)
+  def num_interop_threads(), do: :erlang.nif_error(:undef)
+  def set_adaptive_threads(_adaptive), do: :erlang.nif_error(:undef)
+  def memory_stats(), do: :erlang.nif_error(:undef)
+  def set_cpu_cache_limit(_limit), do: :erlang.nif_error(:undef)
   def item(_tensor), do: :erlang.nif_error(:undef)
   def scalar_type(_tensor), do: :erlang.nif_error(:undef)
   def shape(_tensor), do: :erlang.nif_error(:undef)
@@ -117,7 +169,39 @@ defmodule Torchx.NIF do
   def device_of(_tensor), do: :erlang.nif_error(:undef)
   def nbytes(_tensor), do: :erlang.nif_error(:undef)
   def to_blob_view(_tensor), do: :erlang.nif_error(:undef)
+  def graph_new(), do: :erlang.nif_error(:undef)
+  def graph_input(_graph), do: :erlang.nif_error(:undef)
+  def graph_constant(_graph, _tensor), do: :erlang.nif_error(:undef)
+  def graph_node(_graph, _kind, _args), do: :erlang.nif_error(:undef)
+  def graph_optimized(_executor), do: :erlang.nif_error(:undef)
+
+  dnif await(tensor)
+
+  def async_call(_name, _args, _device), do: :erlang.nif_error(:undef)
+
+  # Ops which do not return a single tensor always run synchronously,
+  # as do in-place ops, which must consume their handle on the caller
+  @sync_ops [:to_blob, :delete_tensor, :split, :qr, :eval_program, :graph_compile, :graph_run]
+  @sync_ops @sync_ops ++ [:add_, :subtract_, :multiply_, :divide_, :power_]
+
+  def call(func, device, args) do
+    if Process.get(:torchx_async, false) and func not in @sync_ops do
+      async_call(func, args, Torchx.torch_device(device))
+    else
+      sync_call(func, device, args)
+    end
+  end
+
+  # Ops on existing tensors, which run on the device of their first
+  # tensor argument. It is found natively, as the tensor may be pending.
+  def call(func, args) do
+    if Process.get(:torchx_async, false) and func not in @sync_ops do
+      async_call(func, args, Torchx.torch_device(:cpu))
+    else
+      apply(__MODULE__, func, args)
+    end
+  end
 
-  def call(func, :cpu, args), do: apply(__MODULE__, func, args)
-  def call(func, _device, args), do: apply(__MODULE__, :"#{func}_io", args)
+  defp sync_call(func, :cpu, args), do: apply(__MODULE__, func, args)
+  defp sync_call(func, _device, args), do: apply(__MODULE__, :"#{func}_io", args)
 end
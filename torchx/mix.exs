@@ -28,6 +28,7 @@ defmodule Torchx.MixProject do
     [
       {:nx, path: "../nx"},
       {:elixir_make, "~> 0.6"},
+      {:benchee, "~> 1.0", only: :dev},
       {:ex_doc, "~> 0.23", only: :dev}
     ]
   end
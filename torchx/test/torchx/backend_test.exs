@@ -145,9 +145,111 @@ defmodule Torchx.BackendTest do
         fn -> Nx.sum(t) end
       )
     end
+
+    for op <- [:product, :reduce_max, :reduce_min] do
+      test "#{op}" do
+        t = tt([[1, -2, 3], [4, 5, -6]], {:s, 32})
+        b = Nx.backend_transfer(t, Nx.BinaryBackend)
+
+        for opts <- [[], [axes: [0]], [axes: [1], keep_axes: true]] do
+          assert Nx.backend_transfer(apply(Nx, unquote(op), [t, opts])) ==
+                   apply(Nx, unquote(op), [b, opts])
+        end
+      end
+    end
+  end
+
+  describe "windows" do
+    for op <- [:window_sum, :window_product, :window_max, :window_min, :window_mean] do
+      test "#{op}" do
+        t = tt([[[4, 2, 1, 3], [4, 2, 1, 7]], [[1, 2, 5, 7], [1, 8, 9, 2]]], {:f, 32})
+        b = Nx.backend_transfer(t, Nx.BinaryBackend)
+
+        for opts <- [[], [strides: [1, 2, 1], padding: :same], [window_dilations: [1, 1, 2]]] do
+          assert Nx.backend_transfer(apply(Nx, unquote(op), [t, {1, 2, 2}, opts])) ==
+                   apply(Nx, unquote(op), [b, {1, 2, 2}, opts])
+        end
+      end
+    end
+
+    test "conv" do
+      t = Nx.iota({2, 3, 4, 4}, type: {:f, 32}, backend: TB)
+      k = Nx.iota({6, 1, 2, 2}, type: {:f, 32}, backend: TB)
+      bt = Nx.backend_transfer(t, Nx.BinaryBackend)
+      bk = Nx.backend_transfer(k, Nx.BinaryBackend)
+
+      opts = [
+        strides: [2, 1],
+        padding: [{1, 0}, {0, 2}],
+        input_dilation: [1, 2],
+        kernel_dilation: [2, 1],
+        feature_group_size: 3
+      ]
+
+      assert Nx.backend_transfer(Nx.conv(t, k, opts)) == Nx.conv(bt, bk, opts)
+
+      permuted = [input_permutation: [0, 3, 1, 2], output_permutation: [0, 2, 3, 1]]
+      t = Nx.transpose(t, axes: [0, 2, 3, 1])
+      bt = Nx.transpose(bt, axes: [0, 2, 3, 1])
+
+      assert Nx.backend_transfer(Nx.conv(t, k, permuted)) == Nx.conv(bt, bk, permuted)
+    end
+  end
+
+  describe "sort" do
+    test "along axes" do
+      t = tt([[3, 1, 7], [2, 5, 4]], {:s, 64})
+      b = Nx.backend_transfer(t, Nx.BinaryBackend)
+
+      for opts <- [[axis: 0], [axis: 1], [axis: 1, comparator: :asc]] do
+        assert Nx.backend_transfer(Nx.sort(t, opts)) == Nx.sort(b, opts)
+      end
+    end
+  end
+
+  describe "views" do
+    test "slices, transposes and broadcasts are materialized on transfer" do
+      t = Nx.iota({4, 6}, backend: TB)
+      b = Nx.iota({4, 6})
+
+      assert Nx.backend_transfer(Nx.slice(t, [1, 1], [2, 3])) == Nx.slice(b, [1, 1], [2, 3])
+
+      assert Nx.backend_transfer(Nx.slice(t, [1, 0], [3, 5], strides: [2, 2])) ==
+               Nx.slice(b, [1, 0], [3, 5], strides: [2, 2])
+
+      assert Nx.backend_transfer(Nx.transpose(t)) == Nx.transpose(b)
+      assert Nx.backend_transfer(Nx.broadcast(Nx.tensor([1, 2, 3], backend: TB), {2, 3})) ==
+               Nx.broadcast(Nx.tensor([1, 2, 3]), {2, 3})
+    end
+
+    test "operations on views" do
+      t = Nx.iota({4, 6}, backend: TB)
+      b = Nx.iota({4, 6})
+
+      assert Nx.backend_transfer(Nx.add(Nx.transpose(t), 1)) == Nx.add(Nx.transpose(b), 1)
+
+      assert Nx.backend_transfer(Nx.sum(Nx.slice(t, [0, 2], [4, 2]))) ==
+               Nx.sum(Nx.slice(b, [0, 2], [4, 2]))
+    end
   end
 
   describe "creation" do
+    test "from_binary shares the binary on the CPU" do
+      binary = for i <- 1..1024, into: <<>>, do: <<i::32-float-native>>
+      t = Nx.from_binary(binary, {:f, 32}, backend: TB)
+      :erlang.garbage_collect()
+
+      assert Nx.backend_transfer(t) == Nx.from_binary(binary, {:f, 32})
+      assert Nx.backend_transfer(Nx.add(t, 1)) == Nx.add(Nx.from_binary(binary, {:f, 32}), 1)
+    end
+
+    test "from_binary copies misaligned binaries" do
+      <<_, binary::binary>> = for i <- 0..1024, into: <<0>>, do: <<i::32-float-native>>
+      t = Nx.from_binary(binary, {:f, 32}, backend: TB)
+
+      assert Nx.backend_transfer(t) == Nx.from_binary(binary, {:f, 32})
+    end
+
     test "eye" do
       t = Nx.eye({9, 9}, backend: TB) |> Nx.backend_transfer()
       one = Nx.tensor(1)
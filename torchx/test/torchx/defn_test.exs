@@ -16,6 +16,69 @@ defmodule Torchx.DefnTest do
   # because we want to raise on type mismatches
   # as we develop the lib.
 
+  describe "compiler" do
+    @defn_compiler Torchx
+    defn softmax(t), do: Nx.exp(t) / Nx.sum(Nx.exp(t))
+
+    @defn_compiler Torchx
+    defn dense(x, w, b), do: Nx.logistic(Nx.dot(x, w) + b)
+
+    @defn_compiler Torchx
+    defn slice_and_compare(t), do: {Nx.transpose(t[1..2]), t > 2, Nx.select(t > 2, t, 0)}
+
+    defp assert_all_close(left, right) do
+      assert Nx.all_close?(Nx.backend_transfer(left), right) ==
+               Nx.tensor(1, type: {:u, 8}, backend: Nx.BinaryBackend)
+    end
+
+    test "runs element-wise ops and reductions" do
+      t = Nx.tensor([1.0, 2.0, 3.0], backend: Nx.BinaryBackend)
+      assert_all_close(softmax(t), Nx.divide(Nx.exp(t), Nx.sum(Nx.exp(t))))
+    end
+
+    test "runs dot products with broadcasting" do
+      x = Nx.tensor([[1.0, 2.0]], backend: Nx.BinaryBackend)
+      w = Nx.tensor([[0.5, -0.5], [0.25, 0.0]], backend: Nx.BinaryBackend)
+      b = Nx.tensor([0.0, 1.0], backend: Nx.BinaryBackend)
+      assert_all_close(dense(x, w, b), Nx.logistic(Nx.add(Nx.dot(x, w), b)))
+    end
+
+    test "returns tuples with the expected types" do
+      t = Nx.iota({3, 2}, backend: Nx.BinaryBackend)
+      {sliced, greater, selected} = slice_and_compare(t)
+
+      assert Nx.backend_transfer(sliced) ==
+               Nx.tensor([[2, 4], [3, 5]], backend: Nx.BinaryBackend)
+
+      assert Nx.backend_transfer(greater) ==
+               Nx.tensor([[0, 0], [0, 1], [1, 1]], type: {:u, 8}, backend: Nx.BinaryBackend)
+
+      assert Nx.backend_transfer(selected) ==
+               Nx.tensor([[0, 0], [0, 3], [4, 5]], backend: Nx.BinaryBackend)
+    end
+
+    test "fuses element-wise ops once profiled" do
+      alias Torchx.NIF
+
+      # exp(a + b) * b
+      {:ok, graph} = NIF.graph_new()
+      {:ok, a} = NIF.graph_input(graph)
+      {:ok, b} = NIF.graph_input(graph)
+      {:ok, add} = NIF.graph_node(graph, :"aten::add", [{:value, a}, {:value, b}])
+      {:ok, exp} = NIF.graph_node(graph, :"aten::exp", [{:value, add}])
+      {:ok, mul} = NIF.graph_node(graph, :"aten::mul", [{:value, exp}, {:value, b}])
+      {:ok, executor} = NIF.graph_compile(graph, [mul])
+
+      {:cpu, a} = Torchx.arange(0, 1000, 1, type: :float)
+      {:cpu, b} = Torchx.arange(1000, 2000, 1, type: :float)
+
+      for _ <- 1..3, do: {:ok, [_]} = NIF.graph_run(executor, [a, b])
+
+      {:ok, optimized} = NIF.graph_optimized(executor)
+      assert List.to_string(optimized) =~ "prim::TensorExprGroup"
+    end
+  end
+
   describe "scalar" do
     defn float_scalar(x), do: Nx.add(1.0, x)
     defn integer_scalar(x), do: Nx.add(1, x)
@@ -20,5 +20,173 @@ defmodule TorchxTest do
 
       assert is_reference(ref)
     end
+
+    test "fast path threshold" do
+      {:cpu, a} = Torchx.arange(0, 3, 1, type: :int)
+
+      try do
+        for threshold <- [0, 1024] do
+          :ok = Torchx.set_fast_path_threshold(threshold)
+          assert {:ok, ref} = Torchx.NIF.add(a, a)
+          assert Torchx.NIF.to_blob(ref) == <<0::32-native, 2::32-native, 4::32-native>>
+        end
+      after
+        Torchx.set_fast_path_threshold(1024)
+      end
+    end
+
+    test "thread control" do
+      threads = Torchx.num_threads()
+      assert threads > 0
+      assert Torchx.num_interop_threads() > 0
+
+      try do
+        :ok = Torchx.set_num_threads(1)
+        assert Torchx.num_threads() == 1
+
+        :ok = Torchx.set_adaptive_threads(true)
+        {:cpu, ref} = Torchx.tensordot(Torchx.arange(0, 3), Torchx.arange(4, 7), [0], [0])
+        assert is_reference(ref)
+      after
+        Torchx.set_adaptive_threads(false)
+        Torchx.set_num_threads(threads)
+      end
+    end
+
+    test "cumsum and argsort" do
+      {:cpu, ref} = Torchx.cumsum(Torchx.arange(1, 5, 1, type: :int), 0)
+      assert Torchx.type_of(ref) == :int
+      assert Torchx.NIF.to_blob(ref) == for(i <- [1, 3, 6, 10], into: <<>>, do: <<i::32-native>>)
+
+      t = Torchx.arange(0, 3, 1, type: :float)
+      {:cpu, ref} = Torchx.argsort(t, 0, descending: true)
+      assert Torchx.NIF.to_blob(ref) == <<2::64-native, 1::64-native, 0::64-native>>
+    end
+
+    test "async execution" do
+      {:cpu, ref} =
+        Torchx.async(fn ->
+          a = Torchx.arange(0, 3, 1, type: :float)
+          Torchx.add(Torchx.cumsum(a, 0), a)
+        end)
+
+      assert Torchx.NIF.to_blob(ref) == f32([0.0, 2.0, 5.0])
+
+      # In-place ops run synchronously after the queued ops reading their input
+      {:cpu, ref} =
+        Torchx.async(fn ->
+          a = Torchx.arange(0, 3, 1, type: :float)
+          sum = Torchx.cumsum(a, 0)
+          Torchx.add_(a, Torchx.arange(1, 4, 1, type: :float))
+          sum
+        end)
+
+      assert Torchx.NIF.to_blob(ref) == f32([0.0, 1.0, 3.0])
+
+      # Metadata reads of pending tensors wait on a dirty scheduler
+      {:cpu, ref} = Torchx.async(fn -> Torchx.arange(0, 1_000_000, 1, type: :float) end)
+      assert Torchx.shape_of(ref) == {1_000_000}
+
+      failed =
+        Torchx.async(fn ->
+          Torchx.tensordot(Torchx.arange(0, 3), Torchx.arange(0, 4), [0], [0])
+        end)
+
+      assert_raise RuntimeError, ~r/^Torchx: /, fn -> Torchx.await(failed) end
+      assert {:error, _} = Torchx.NIF.to_blob(elem(failed, 1))
+    end
+
+    test "async execution of Nx operations" do
+      x = Nx.iota({2, 3}, type: {:f, 32}, backend: Torchx.Backend)
+      w = Nx.iota({3, 2}, type: {:f, 32}, backend: Torchx.Backend)
+
+      %Nx.Tensor{data: %Torchx.Backend{ref: ref}} =
+        result = Torchx.async(fn -> x |> Nx.dot(w) |> Nx.add(1) end)
+
+      assert Torchx.await({:cpu, ref}) == {:cpu, ref}
+      assert Nx.backend_transfer(result) == Nx.tensor([[11.0, 14.0], [29.0, 41.0]])
+    end
+
+    test "memory stats" do
+      %{cache_hits: hits, peak_bytes_in_use: peak} = Torchx.memory_stats()
+
+      {:cpu, ref} = Torchx.arange(0, 1_000_000, 1, type: :float)
+      assert Torchx.memory_stats().peak_bytes_in_use >= max(peak, 4_000_000)
+      :ok = Torchx.NIF.delete_tensor(ref)
+
+      # A block of the same size class is reused from the cache
+      {:cpu, _ref} = Torchx.arange(0, 1_000_000, 1, type: :float)
+      assert Torchx.memory_stats().cache_hits > hits
+    end
+
+    test "in-place operations consume their left operand" do
+      a = Torchx.arange(0, 3, 1, type: :float)
+      b = Torchx.arange(4, 7, 1, type: :float)
+
+      {:cpu, ref} = c = Torchx.add_(a, b)
+      assert Torchx.NIF.to_blob(ref) == f32([4.0, 6.0, 8.0])
+
+      assert {:error, 'Tensor t has been consumed by an in-place operation.'} =
+               Torchx.NIF.shape(elem(a, 1))
+
+      # Sized ops check the handle before choosing a scheduler
+      assert {:error, 'Tensor a has been consumed by an in-place operation.'} =
+               Torchx.NIF.add(elem(a, 1), elem(b, 1))
+
+      {:cpu, ref} = Torchx.multiply_(c, b)
+      assert Torchx.NIF.to_blob(ref) == f32([16.0, 30.0, 48.0])
+
+      # Integer division cannot be done in place
+      ints = Torchx.arange(2, 5, 2, type: :int)
+      {:cpu, ref} = Torchx.divide_(ints, Torchx.arange(1, 3, 1, type: :int))
+      assert Torchx.type_of(ref) == :float
+      assert Torchx.NIF.to_blob(ref) == f32([2.0, 2.0])
+    end
+
+    test "in-place operations do not update shared memory" do
+      {:cpu, base} = Torchx.arange(0, 4, 1, type: :float)
+      {:ok, view} = Torchx.NIF.narrow(base, 0, 0, 2)
+
+      {:cpu, ref} = Torchx.add_({:cpu, view}, Torchx.arange(1, 3, 1, type: :float))
+      assert Torchx.NIF.to_blob(ref) == f32([1.0, 3.0])
+      assert Torchx.NIF.to_blob(base) == f32([0.0, 1.0, 2.0, 3.0])
+
+      assert {:error, 'Tensor t has been consumed by an in-place operation.'} =
+               Torchx.NIF.shape(view)
+    end
+
+    test "in-place operations do not update tensors exposed as binaries" do
+      {:cpu, ref} = a = Torchx.arange(0, 3, 1, type: :float)
+      binary = Torchx.NIF.to_blob_view(ref)
+
+      {:cpu, ref} = Torchx.add_(a, Torchx.arange(1, 4, 1, type: :float))
+      assert Torchx.NIF.to_blob(ref) == f32([1.0, 3.0, 5.0])
+      assert binary == f32([0.0, 1.0, 2.0])
+    end
+
+    test "eval_program" do
+      a = Torchx.arange(0, 3, 1, type: :int)
+      b = Torchx.arange(4, 7, 1, type: :int)
+      program = [{:add, [0, 1]}, {:multiply, [2, 1]}, {:negate, [3]}]
+
+      assert [{:cpu, mul}, {:cpu, neg}] = Torchx.eval_program([a, b], program, [3, 4])
+      assert Torchx.shape_of(neg) == {3}
+      assert Torchx.NIF.to_blob(mul) == <<16::32-native, 30::32-native, 48::32-native>>
+      assert Torchx.NIF.to_blob(neg) == <<-16::32-native, -30::32-native, -48::32-native>>
+    end
+
+    test "eval_program with invalid instructions" do
+      a = Torchx.arange(0, 3)
+
+      assert_raise RuntimeError, ~r"Unknown program op unknown", fn ->
+        Torchx.eval_program([a], [{:unknown, [0]}], [1])
+      end
+
+      assert_raise RuntimeError, ~r"Invalid slot for program op add", fn ->
+        Torchx.eval_program([a], [{:add, [0, 1]}], [1])
+      end
+    end
   end
+
+  defp f32(list), do: for(x <- list, into: <<>>, do: <<x::float-32-native>>)
 end